@@ -0,0 +1,82 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file deliveryChannel.h
+ * @brief Output port with its own delivery policy: latest frame only, optionally rate capped.
+ *
+ * Frames are written in background. While a frame is being sent the following ones are dropped, so
+ * a slow subscriber only slows down this channel and never the video thread or the other ports.
+ * The pixels of the decoded frame are sent without copy, the channel keeps a reference on them until
+ * the write is over.
+ */
+
+#ifndef _deliveryChannel_H_
+#define _deliveryChannel_H_
+
+#include <string>
+#include <yarp/sig/all.h>
+#include <yarp/os/all.h>
+#include <opencv2/opencv.hpp>
+
+class deliveryChannel {
+private:
+    yarp::os::Port port;
+    yarp::sig::ImageOf<yarp::sig::PixelBgr> image;     // wraps the pixels of inFlight
+    cv::Mat inFlight;                                   // frame being sent
+    double minPeriod;                                   // minimum time between two frames, 0 for no cap
+    double lastSentTime;
+    int framesDropped;
+
+public:
+    /**
+     * @param t_maxRate maximum rate of the channel in frames per second, 0 for no cap
+     */
+    explicit deliveryChannel(double t_maxRate = 0.0);
+
+    bool open(const std::string &name);
+
+    /**
+     * Send frame unless the previous one is still being sent or the rate cap is reached
+     * @param frame BGR frame, shared with the channel until the write is over
+     * @param stamp envelope of the frame
+     * @return true if the frame is sent
+     */
+    bool offer(const cv::Mat &frame, yarp::os::Stamp &stamp);
+
+    /**
+     * @return true if the pixels of frame are still being sent, the caller must not write into them
+     */
+    bool isSending(const cv::Mat &frame);
+
+    bool hasSubscribers();
+
+    /**
+     * @return frames not sent because the subscribers were still busy with the previous one
+     */
+    int getFramesDropped() const;
+
+    void interrupt();
+
+    void close();
+};
+
+#endif  //_deliveryChannel_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
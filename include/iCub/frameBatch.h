@@ -0,0 +1,90 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file frameBatch.h
+ * @brief Several consecutive BGR frames of the same size, sent as a single message.
+ *
+ * On the wire: version, count, width, height, then (timestamp frame_index) per frame and a single
+ * block with the packed pixels of all the frames. Consumers read it with a
+ * yarp::os::BufferedPort<frameBatch> and access each frame without copy through getFrame().
+ */
+
+#ifndef _frameBatch_H_
+#define _frameBatch_H_
+
+#include <vector>
+#include <yarp/os/all.h>
+#include <opencv2/opencv.hpp>
+
+#define FRAME_BATCH_VERSION 1
+
+// a batch read with more is rejected before any allocation, its header is corrupted or hostile
+#define FRAME_BATCH_MAX_FRAMES  1024
+#define FRAME_BATCH_MAX_SIDE    16384               // pixels
+#define FRAME_BATCH_MAX_BYTES   (1024LL * 1024 * 1024)
+
+class frameBatch : public yarp::os::Portable {
+private:
+    int width, height;
+    std::vector<double> timestamps;
+    std::vector<int> frameIndexes;
+    std::vector<unsigned char> pixels;  // frames packed one after the other, rows without padding, only grows
+
+    size_t frameBytes() const;
+
+public:
+    frameBatch();
+
+    /**
+     * Empty the batch and set the size of its frames, the memory of the previous frames is kept
+     * @param t_capacity number of frames to make room for
+     */
+    void reset(int t_width, int t_height, int t_capacity = 0);
+
+    /**
+     * Append a frame at the end of the batch
+     * @param frame BGR frame of the size of the batch
+     * @return false if the size differs
+     */
+    bool append(const cv::Mat &frame, int frameIndex, double timestamp);
+
+    int size() const;
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+    /**
+     * @return view on frame i, valid until the batch is modified
+     */
+    cv::Mat getFrame(int i);
+
+    double getTimestamp(int i) const;
+
+    int getFrameIndex(int i) const;
+
+    bool read(yarp::os::ConnectionReader &connection) override;
+
+    bool write(yarp::os::ConnectionWriter &connection) override;
+};
+
+#endif  //_frameBatch_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
@@ -0,0 +1,117 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file frameServer.h
+ * @brief Rpc port serving single frames of the video, independently from the playback.
+ *
+ * The request \c get \c frame \c <index> \c [<x1> \c <y1> \c <x2> \c <y2>] is replied with the image of the frame,
+ * cropped from Point(x1, y1) to Point(x2, y2) if required, or an empty image if the frame does not exist.
+ * Frames are decoded by chunks with their own VideoCapture, the last chunks are kept so that neighbouring
+ * requests are served without decoding. By default a chunk spans a keyframe interval of the video, so that the
+ * frames the backend decodes to reach a chunk are never more than the chunk itself.
+ *
+ * The request \c get \c preview \c <path> is replied with the contact sheet of a video, or an empty image
+ * while it is being generated.
+ */
+
+#ifndef _frameServer_H_
+#define _frameServer_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <yarp/sig/all.h>
+#include <yarp/os/all.h>
+#include <opencv2/opencv.hpp>
+
+#include "gopReader.h"
+#include "previewGenerator.h"
+#include "videoProbeCache.h"
+
+class frameServer : public yarp::os::PortReader {
+private:
+    typedef std::list<std::pair<int, std::vector<cv::Mat> > > chunkList;
+
+    yarp::os::Port port;
+    yarp::os::Semaphore mutex;          // requests may come from several connections at once, held while decoding
+
+    // video to serve, set by the playback thread which never waits for a decode
+    yarp::os::Semaphore videoMutex;
+    std::string videoPath;
+    unsigned int videoGeneration;       // incremented at each change of video
+
+    // only used with mutex held
+    videoProbeCache &probeCache;        // keeps the keyframe interval once measured
+    gopReader reader;
+    unsigned int servedGeneration;      // generation of the video opened by reader
+
+    const int fixedChunkSize;           // frames decoded at once, 0 for the keyframe interval of each video
+    int chunkSize;                      // chunk size of the current video, 0 until it is opened
+    const size_t cacheCapacity;         // chunks kept in memory
+    const size_t memoryBytes;           // bound of the cached chunks and of the one being decoded
+    chunkList chunks;                   // most recently used first
+    std::map<int, chunkList::iterator> chunkIndex;     // first frame of a chunk -> chunk
+
+    previewGenerator *previews;         // source of the contact sheets, nullptr if none
+
+public:
+    /**
+     * @param t_probeCache cache of the video metadata, shared with the player
+     * @param t_chunkSize frames decoded at once, 0 to use the keyframe interval of each video
+     * @param t_cacheCapacity number of chunks kept in memory
+     * @param t_memoryMegabytes memory the chunks may take, the chunk size is reduced to fit
+     */
+    frameServer(videoProbeCache &t_probeCache, int t_chunkSize, int t_cacheCapacity, int t_memoryMegabytes);
+
+    bool open(const std::string &name);
+
+    /**
+     * Serve the contact sheets of a preview generator
+     */
+    void setPreviewSource(previewGenerator *t_previews);
+
+    /**
+     * Serve the frames of another video. Only records the path, the next request drops the cache and opens it
+     */
+    void setVideo(const std::string &path);
+
+    /**
+     * Get a frame from the cache, decoding its chunk if needed
+     * @param index index of the frame in the video
+     * @param frame filled with the frame, shared with the cache
+     * @return false if the frame does not exist
+     */
+    bool getFrame(int index, cv::Mat &frame);
+
+    /**
+     * Reply to a request received on the port
+     */
+    bool read(yarp::os::ConnectionReader &connection) override;
+
+    void interrupt();
+
+    void close();
+};
+
+#endif  //_frameServer_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
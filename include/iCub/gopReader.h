@@ -0,0 +1,133 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file gopReader.h
+ * @brief Decoder of runs of consecutive frames (a group of pictures) with its own VideoCapture.
+ */
+
+#ifndef _gopReader_H_
+#define _gopReader_H_
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#define MAX_KEYFRAME_INTERVAL 300   // largest keyframe interval measured, frames
+
+// raw packets carry their keyframe flag (FFmpeg backend)
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+#define GOP_READER_RAW_PACKETS
+#endif
+
+class gopReader {
+private:
+    cv::VideoCapture capture;
+    std::string videoPath;
+    int nextIndex;                  // index of the frame the next read returns
+
+    /**
+     * Keyframe interval from the flags of the raw packets, without decoding
+     * @return 0 if the backend does not provide raw packets
+     */
+    int scanKeyframeInterval();
+
+    // keyframe interval measured in steps
+    int measureStep;                // next step, -1 once done
+    int measuredInterval;
+    double frameTime;               // decode time of a frame, in ticks
+
+    /**
+     * @return decode time of a frame read in sequence, in ticks, 0 if no frame can be read
+     */
+    double timeFrameDecode();
+
+    bool finishKeyframeMeasure(int interval);
+
+public:
+    gopReader();
+
+    /**
+     * Indexes of all the keyframes of a video, from the flags of its raw packets, without decoding
+     * @param path video file
+     * @param keyframes filled with the indexes, in increasing order
+     * @return false if the backend does not provide raw packets
+     */
+    static bool scanKeyframes(const std::string &path, std::vector<int> &keyframes);
+
+    /**
+     * Open a video, independently from any other capture on the same file
+     * @return false if the video cannot be opened
+     */
+    bool open(const std::string &path);
+
+    void release();
+
+    bool isOpened() const;
+
+    const std::string &getPath() const;
+
+    /**
+     * Measure the interval between keyframes of the opened video, up to MAX_KEYFRAME_INTERVAL.
+     * Chunks of that many frames cost at most twice their decode whatever their alignment: the seek to their
+     * first frame decodes less than an interval before it.
+     * @return interval in frames, at least 1
+     */
+    int measureKeyframeInterval();
+
+    /**
+     * Start measuring the keyframe interval in steps, so that the measure can be interleaved with decodes.
+     * The raw packets are scanned in a single step when the backend provides them, otherwise the interval is
+     * estimated from the time of seeks at uneven positions, which grows with the frames decoded from the
+     * previous keyframe: one seek per step, each costing at most one interval of decoding.
+     */
+    void beginKeyframeMeasure();
+
+    /**
+     * @return true once the measure is done
+     */
+    bool stepKeyframeMeasure();
+
+    /**
+     * @return keyframe interval measured, 0 if the measure is not done
+     */
+    int getKeyframeInterval() const;
+
+    /**
+     * @param frames wanted chunk size
+     * @param memoryBytes memory available for the chunks
+     * @param chunksHeld number of chunks held at once
+     * @return largest chunk size up to frames such that chunksHeld chunks of the video fit in memoryBytes, at least 1
+     */
+    int fitChunk(int frames, size_t memoryBytes, int chunksHeld);
+
+    /**
+     * Decode the frames [first, first + count). A single seek is done when first is not the
+     * next frame, the backend restarts from the previous keyframe and the rest is decoded forward.
+     * @param first index of the first frame
+     * @param count number of frames wanted
+     * @param frames filled with the decoded frames, fewer than count at the end of the video
+     * @return number of frames decoded
+     */
+    int decode(int first, int count, std::vector<cv::Mat> &frames);
+};
+
+#endif  //_gopReader_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
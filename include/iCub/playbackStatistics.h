@@ -0,0 +1,90 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file playbackStatistics.h
+ * @brief Timing figures of the frames actually sent by the player, reported through rpc.
+ */
+
+#ifndef _playbackStatistics_H_
+#define _playbackStatistics_H_
+
+#include <deque>
+#include <yarp/os/all.h>
+
+class playbackStatistics {
+private:
+    yarp::os::Semaphore mutex;
+    std::deque<double> frameTimes;      // send time of the last frames, oldest first
+    size_t windowSize;
+    int framesSent, framesRepeated, ticksDropped;
+    int frameWidth, frameHeight;
+    double switchRequestTime;           // time of the pending video change, negative if none
+    double switchDuration;              // time from the last video change request to its first frame
+
+public:
+    /**
+     * @param t_windowSize number of frames the fps and jitter are computed on
+     */
+    explicit playbackStatistics(size_t t_windowSize = 100);
+
+    /**
+     * Forget the figures of the previous video
+     */
+    void reset();
+
+    /**
+     * Record a frame sent at time with the given size
+     */
+    void frameSent(double time, int width, int height);
+
+    /**
+     * Record a frame not sent because unchanged, announced on the repeat port instead
+     */
+    void frameRepeated();
+
+    /**
+     * Record output ticks skipped because the player was late
+     */
+    void ticksSkipped(int count);
+
+    /**
+     * Record the request for a new video, the duration is taken when its first frame is sent
+     */
+    void switchRequested(double time);
+
+    /**
+     * @return fps achieved over the window, 0 if less than two frames were sent
+     */
+    double getFPS();
+
+    /**
+     * @return standard deviation of the inter-frame interval over the window, in seconds
+     */
+    double getJitter();
+
+    /**
+     * Fill reply with (fps f) (jitter j) (frames n) (repeated r) (dropped d) (size w h) (switch s)
+     */
+    void report(yarp::os::Bottle &reply);
+};
+
+#endif  //_playbackStatistics_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
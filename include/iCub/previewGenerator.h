@@ -0,0 +1,116 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file previewGenerator.h
+ * @brief Background, low priority job building a contact sheet of downscaled frames sampled across a video.
+ *
+ * The sheets are kept in the videoProbeCache with the other metadata of the file. The job runs with the lowest
+ * scheduling priority and sleeps so that the cpu time of its thread stays within a fraction (its budget) of a core.
+ * The thumbnails are taken at keyframes when the backend gives the raw packets, a seek then decodes a single frame.
+ * The decode (when the backend lets the number of threads be set) and the downscale run on the thread itself, so
+ * that they are niced and counted in the budget.
+ */
+
+#ifndef _previewGenerator_H_
+#define _previewGenerator_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include <yarp/os/Thread.h>
+#include <opencv2/opencv.hpp>
+
+#include "videoProbeCache.h"
+
+#define PREVIEW_MAX_PENDING 16      // videos waiting for their sheet, the oldest requests are dropped beyond
+
+// the number of decoding threads can be set when the capture is opened
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+#define PREVIEW_SINGLE_THREAD_DECODE
+#endif
+
+class previewGenerator : public yarp::os::Thread {
+private:
+    videoProbeCache &probeCache;
+
+    const int columns, rows;            // thumbnails of the sheet
+    const int thumbnailWidth;           // pixels, the height follows the aspect ratio of the video
+    const double cpuBudget;             // fraction of a core the job may use, in (0, 1]
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::string> pending;    // videos waiting for their sheet
+
+    /**
+     * Sample the video and build its sheet
+     * @return empty if the video cannot be read
+     */
+    cv::Mat buildContactSheet(const std::string &path);
+
+    /**
+     * @return cpu time used by the calling thread, in seconds (wall clock where not available)
+     */
+    static double threadTime();
+
+    /**
+     * Area average of frame into tile on the calling thread, cv::resize would use the parallel pool of OpenCV
+     */
+    static void downscale(const cv::Mat &frame, cv::Mat &tile);
+
+    /**
+     * Sleep long enough for the cpu time used since workStart (see threadTime()) to stay within the budget
+     */
+    void yieldBudget(double workStart);
+
+public:
+    /**
+     * @param t_probeCache cache where the sheets are stored
+     * @param t_columns thumbnails per row
+     * @param t_rows rows of thumbnails
+     * @param t_thumbnailWidth width of a thumbnail in pixels
+     * @param t_cpuBudget fraction of a core the job may use
+     */
+    previewGenerator(videoProbeCache &t_probeCache, int t_columns, int t_rows, int t_thumbnailWidth,
+                     double t_cpuBudget);
+
+    /**
+     * Get the sheet of a video, its generation is queued if it is not ready. Beyond PREVIEW_MAX_PENDING videos
+     * waiting, the oldest request is dropped: ask again later
+     * @param path path of the video
+     * @param sheet filled with the sheet when ready
+     * @return false if the sheet is not ready yet
+     */
+    bool getPreview(const std::string &path, cv::Mat &sheet);
+
+    /**
+     * Lowers the priority of the thread
+     */
+    bool threadInit() override;
+
+    void run() override;
+
+    void onStop() override;
+};
+
+#endif  //_previewGenerator_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
@@ -0,0 +1,133 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file readAheadStream.h
+ * @brief Sequential read ahead of the video file in large chunks, on a thread of its own.
+ *
+ * With OpenCV 4.11 or newer the decoder reads the file through this class (cv::IStreamReader), from a
+ * bounded ring filled ahead of it. With older versions the capture reads the file itself, and the ring is
+ * filled ahead of the position of the decoder to keep the file in the page cache.
+ */
+
+#ifndef _readAheadStream_H_
+#define _readAheadStream_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <yarp/os/Thread.h>
+#include <opencv2/opencv.hpp>
+
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 11)
+#define READ_AHEAD_STREAM_READER
+#define READ_AHEAD_OVERRIDE override
+#else
+#define READ_AHEAD_OVERRIDE
+#endif
+
+#define READ_AHEAD_CHUNK (1024 * 1024)
+#define READ_AHEAD_RETRIES 10           // consecutive failed reads before giving up on the file
+
+class readAheadStream : public yarp::os::Thread
+#ifdef READ_AHEAD_STREAM_READER
+        , public cv::IStreamReader
+#endif
+{
+private:
+    int fd;
+    long long fileSize;
+    const size_t chunkSize;             // bytes read at once
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<char> buffer;           // ring of the bytes read ahead
+    long long position;                 // file offset of the next byte the decoder reads
+    size_t head;                        // index of position in buffer
+    size_t filled;                      // bytes of the file available from position
+    unsigned int generation;            // incremented when the ring is dropped, a read in progress is then stale
+    bool endOfFile;
+    bool readError;                     // the file cannot be read anymore, nothing more comes
+    bool refilling;                     // the ring was dropped and the first read at the new position is pending
+    int stalls;                         // times the decoder caught up with data already requested, or a read was retried
+    int refills;                        // times the decoder waited for the ring to refill after a jump
+    bool streaming;
+
+    /**
+     * Move the position of the decoder, keeping the bytes read ahead if possible
+     */
+    void moveTo(long long offset);
+
+public:
+    /**
+     * @param bufferBytes size of the ring
+     * @param chunkBytes size of the reads on the file
+     */
+    readAheadStream(size_t bufferBytes, size_t chunkBytes);
+
+    ~readAheadStream() override;
+
+    /**
+     * Open the file and start reading it ahead
+     * @param path video file
+     * @param t_streaming true if the decoder reads through read() and seek(), false to only keep the page cache warm
+     * @return false if the file cannot be opened
+     */
+    bool open(const std::string &path, bool t_streaming);
+
+    /**
+     * Read bytes of the file, waiting only when the read ahead is behind
+     * @return number of bytes read, 0 at the end of the file
+     */
+    long long read(char *data, long long size) READ_AHEAD_OVERRIDE;
+
+    /**
+     * @param offset offset relative to origin
+     * @param origin SEEK_SET, SEEK_CUR or SEEK_END
+     * @return new position, -1 if out of the file
+     */
+    long long seek(long long offset, int origin) READ_AHEAD_OVERRIDE;
+
+    /**
+     * When the capture reads the file itself, tell how far the decoder is
+     * @param fraction position of the decoder in the video, from 0 to 1
+     */
+    void setDecodePosition(double fraction);
+
+    bool isStreaming() const;
+
+    /**
+     * @return fraction of the ring holding bytes not read yet by the decoder
+     */
+    double getFillLevel();
+
+    int getStalls();
+
+    int getRefills();
+
+    void run() override;
+
+    void onStop() override;
+};
+
+#endif  //_readAheadStream_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
@@ -0,0 +1,110 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file reverseFrameBuffer.h
+ * @brief Frames served backwards: chunks are decoded forward by a worker thread, one chunk ahead of the playback.
+ */
+
+#ifndef _reverseFrameBuffer_H_
+#define _reverseFrameBuffer_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <yarp/os/Thread.h>
+#include <opencv2/opencv.hpp>
+
+#include "gopReader.h"
+#include "videoProbeCache.h"
+
+#define REVERSE_PROVISIONAL_CHUNK 30    // chunk size until the keyframe interval of the video is known
+
+class reverseFrameBuffer : public yarp::os::Thread {
+private:
+    const int fixedChunkSize;       // frames decoded at once, 0 for the keyframe interval of each video
+    const size_t memoryBytes;       // bound of the two chunks held, the one played and the one decoded ahead
+    videoProbeCache &probeCache;    // keeps the keyframe interval once measured
+    gopReader reader;               // only used by the worker
+
+    // chunk being played, only used by the caller of getFrame()
+    int currentFirst;
+    int currentSize;
+    std::vector<cv::Mat> currentFrames;
+
+    // shared with the worker
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::string videoPath;
+    bool videoChanged;
+    int chunkSize;                  // size of the next chunks decoded, 0 until the worker opened the video
+    bool measuring;                 // the keyframe interval is measured in steps between the decodes
+    int requestedIndex;             // frame whose chunk the worker has to decode, -1 if none
+    int decodingFirst, decodingSize;        // chunk the worker is decoding, first -1 if none
+    int prefetchedFirst, prefetchedSize;    // chunk held in prefetchedFrames, first -1 if none
+    std::vector<cv::Mat> prefetchedFrames;
+
+    /**
+     * @return true if the chunk of size frames starting at first holds the frame index
+     */
+    static bool inChunk(int first, int size, int index);
+
+    /**
+     * Open the video in the worker and pick its chunk size, from the keyframe interval if known
+     */
+    void openVideo(const std::string &path);
+
+public:
+    /**
+     * @param t_probeCache cache of the video metadata, shared with the player
+     * @param t_chunkSize number of frames decoded at once, 0 to use the keyframe interval of each video
+     * @param t_memoryMegabytes memory the chunks may take, the chunk size is reduced to fit
+     */
+    reverseFrameBuffer(videoProbeCache &t_probeCache, int t_chunkSize, int t_memoryMegabytes);
+
+    /**
+     * Serve the frames of another video, drops the buffered chunks. The worker opens the video right away and
+     * measures its keyframe interval between the decodes, the caller never waits for the measure.
+     */
+    void setVideo(const std::string &path);
+
+    /**
+     * Get a frame, waiting for the decode of its chunk if needed. The chunk before is prefetched as soon as
+     * a new chunk is entered, so that playing backwards does not wait.
+     * @param index index of the frame in the video
+     * @param frame filled with the frame, shared with the buffer
+     * @return false if the frame is beyond the end of the video
+     */
+    bool getFrame(int index, cv::Mat &frame);
+
+    /**
+     * Decodes the requested chunks
+     */
+    void run() override;
+
+    void onStop() override;
+
+    void threadRelease() override;
+};
+
+#endif  //_reverseFrameBuffer_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
@@ -0,0 +1,93 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file roiPublisher.h
+ * @brief Named regions of interest of the video, each one sent on its own port.
+ */
+
+#ifndef _roiPublisher_H_
+#define _roiPublisher_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <yarp/sig/all.h>
+#include <yarp/os/all.h>
+#include <opencv2/opencv.hpp>
+
+typedef yarp::os::BufferedPort<yarp::sig::ImageOf<yarp::sig::PixelBgr> > roiPort;
+
+class roiPublisher {
+private:
+    struct roiOutput {
+        cv::Rect area;                      // in full frame coordinates
+        std::unique_ptr<roiPort> port;
+    };
+
+    std::map<std::string, roiOutput> rois;
+    std::string portPrefix;                 // the port of a roi is <portPrefix><name>:o
+    yarp::os::Semaphore mutex;              // rois are changed by rpc while the video thread publishes
+
+public:
+    /**
+     * @param t_portPrefix stem of the roi port names, e.g. /yarpVideoModule/roi/
+     */
+    void setPortPrefix(const std::string &t_portPrefix);
+
+    /**
+     * Add a roi and open its port, or move an existing one
+     * @param name name of the roi, letters, digits and _ only
+     * @param area area of the roi in the full frame
+     * @return false if the name is not valid or the port cannot be opened
+     */
+    bool setRoi(const std::string &name, const cv::Rect &area);
+
+    /**
+     * Remove a roi and close its port
+     * @return false if there is no roi with this name
+     */
+    bool removeRoi(const std::string &name);
+
+    /**
+     * Fill reply with a list (name x1 y1 x2 y2) per roi
+     */
+    void listRois(yarp::os::Bottle &reply);
+
+    /**
+     * @return true if a roi port has a connection
+     */
+    bool hasSubscribers();
+
+    /**
+     * Cut every connected roi from frame, in parallel, and send them
+     * @param frame full decoded frame
+     * @param stamp envelope of the roi images
+     */
+    void publish(const cv::Mat &frame, yarp::os::Stamp &stamp);
+
+    void interrupt();
+
+    void close();
+};
+
+#endif  //_roiPublisher_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
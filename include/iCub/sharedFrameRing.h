@@ -0,0 +1,88 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file sharedFrameRing.h
+ * @brief Writer side of the POSIX shared memory frame ring (see sharedFrameRingClient.h for the layout).
+ */
+
+#ifndef _sharedFrameRing_H_
+#define _sharedFrameRing_H_
+
+#include <string>
+#include <opencv2/opencv.hpp>
+
+#include "sharedFrameRingClient.h"
+
+class sharedFrameRing {
+private:
+    std::string shmName;            // name of the segment, e.g. /yarpVideoModule
+    void *mapping;
+    size_t mappingSize;
+    sharedFrameRingHeader *header;
+    uint64_t sequence;              // sequence of the last frame written
+
+    /**
+     * Create and map a new segment, replacing the current one
+     */
+    bool create(unsigned int slotCount, size_t maxFrameBytes);
+
+    /**
+     * Mark the segment as closed for the readers and unmap it
+     */
+    void release();
+
+public:
+    sharedFrameRing();
+
+    ~sharedFrameRing();
+
+    /**
+     * Create the ring
+     * @param name POSIX shared memory name, starting with /
+     * @param slotCount number of frames kept in the ring
+     * @param maxFrameBytes size of the biggest frame expected, the ring grows if a bigger one comes
+     * @return flag for the success
+     */
+    bool open(const std::string &name, unsigned int slotCount, size_t maxFrameBytes);
+
+    /**
+     * Unlink the segment, readers that still map it see it as stale
+     */
+    void close();
+
+    bool isOpen() const;
+
+    const std::string &getName() const;
+
+    /**
+     * Copy a BGR frame in the next slot of the ring
+     * @param frame frame to share
+     * @param frameIndex index of the frame in the video
+     * @param crop active crop of the player, empty if none
+     * @param timestamp time of the frame
+     * @param slot filled with the slot that holds the frame
+     * @return sequence number of the frame, 0 on failure
+     */
+    uint64_t write(const cv::Mat &frame, int frameIndex, const cv::Rect &crop, double timestamp, unsigned int &slot);
+};
+
+#endif  //_sharedFrameRing_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
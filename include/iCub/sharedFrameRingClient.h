@@ -0,0 +1,216 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file sharedFrameRingClient.h
+ * @brief Layout of the shared memory frame ring and a header-only reader for local consumers.
+ *
+ * The segment starts with a sharedFrameRingHeader followed by slotCount slots of slotSize bytes,
+ * each one made of a sharedFrameSlot and the BGR pixels of a full resolution frame.
+ * Frame n (n >= 1) is written in slot (n - 1) % slotCount. While a slot is written its sequence
+ * is odd (2n - 1), once complete it is 2n: a reader that sees the same even sequence before and
+ * after using the pixels knows the frame was not overwritten in the meantime.
+ *
+ * Typical use, with the frame descriptors received on /frameDescriptor:o:
+ *
+ *     sharedFrameRingReader reader;
+ *     reader.open(shmName);
+ *     sharedFrameView view;
+ *     if (reader.acquire(sequence, view)) {
+ *         cv::Mat frame(view.height, view.width, CV_8UC3, (void *) view.data, view.rowBytes);
+ *         ... use frame ...
+ *         if (!reader.validate(view)) { ... frame was overwritten, discard the result ... }
+ *     }
+ */
+
+#ifndef _sharedFrameRingClient_H_
+#define _sharedFrameRingClient_H_
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHARED_FRAME_RING_MAGIC   0x52505659u    // "YVPR"
+#define SHARED_FRAME_RING_VERSION 1u
+
+#define SHARED_FRAME_RING_ALIVE   1u
+#define SHARED_FRAME_RING_CLOSED  0u             // the writer moved to a new segment, reopen by name
+
+#define SHARED_FRAME_PIXEL_BGR    0u
+
+struct sharedFrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;                    // offset of the first slot
+    uint32_t slotCount;
+    uint64_t slotSize;                      // bytes of a slot, slot header included
+    uint64_t maxFrameBytes;                 // bytes available for the pixels of a slot
+    std::atomic<uint32_t> state;
+    std::atomic<uint64_t> lastSequence;     // sequence of the last complete frame, 0 if none
+};
+
+struct sharedFrameSlot {
+    std::atomic<uint64_t> sequence;         // 2n - 1 while frame n is written, 2n once complete
+    double timestamp;                       // yarp::os::Time of the frame
+    uint32_t width, height, rowBytes, pixelFormat;
+    int32_t cropX, cropY, cropWidth, cropHeight;    // active crop of the player, width 0 if none
+    uint64_t frameIndex;                    // index of the frame in the video
+};
+
+#define SHARED_FRAME_SLOT_HEADER_SIZE 64u
+
+/**
+ * Zero-copy view on a frame of the ring, valid until the writer wraps around to its slot
+ */
+struct sharedFrameView {
+    uint64_t sequence;
+    uint32_t slot;
+    const unsigned char *data;
+    uint32_t width, height, rowBytes, pixelFormat;
+    int32_t cropX, cropY, cropWidth, cropHeight;
+    uint64_t frameIndex;
+    double timestamp;
+};
+
+class sharedFrameRingReader {
+private:
+    void *mapping;
+    size_t mappingSize;
+    const sharedFrameRingHeader *header;
+
+    const sharedFrameSlot *slotAt(uint32_t slot) const {
+        return reinterpret_cast<const sharedFrameSlot *>(static_cast<const unsigned char *>(mapping) +
+                                                         header->headerSize + slot * header->slotSize);
+    }
+
+public:
+    sharedFrameRingReader() : mapping(nullptr), mappingSize(0), header(nullptr) {}
+
+    ~sharedFrameRingReader() { close(); }
+
+    /**
+     * Map the ring published by the player
+     * @param name shared memory name, as found in the frame descriptors
+     * @return false if the segment does not exist or has an unknown layout
+     */
+    bool open(const std::string &name) {
+        close();
+
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat segmentStat;
+        if (fstat(fd, &segmentStat) != 0 || static_cast<size_t>(segmentStat.st_size) < sizeof(sharedFrameRingHeader)) {
+            ::close(fd);
+            return false;
+        }
+
+        mappingSize = static_cast<size_t>(segmentStat.st_size);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            return false;
+        }
+
+        header = static_cast<const sharedFrameRingHeader *>(mapping);
+        if (header->magic != SHARED_FRAME_RING_MAGIC || header->version != SHARED_FRAME_RING_VERSION ||
+            header->headerSize + static_cast<uint64_t>(header->slotCount) * header->slotSize > mappingSize) {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close() {
+        if (mapping != nullptr) {
+            munmap(mapping, mappingSize);
+        }
+        mapping = nullptr;
+        header = nullptr;
+        mappingSize = 0;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    /**
+     * @return true if the writer replaced this segment (e.g. bigger frames), the ring has to be opened again
+     */
+    bool isStale() const { return header == nullptr || header->state.load(std::memory_order_acquire) != SHARED_FRAME_RING_ALIVE; }
+
+    uint64_t lastSequence() const { return header ? header->lastSequence.load(std::memory_order_acquire) : 0; }
+
+    /**
+     * Get a view on frame sequence, without copying the pixels
+     * @return false if the frame is not available anymore (or not yet)
+     */
+    bool acquire(uint64_t sequence, sharedFrameView &view) const {
+        if (header == nullptr || sequence == 0) {
+            return false;
+        }
+
+        view.slot = static_cast<uint32_t>((sequence - 1) % header->slotCount);
+        const sharedFrameSlot *frameSlot = slotAt(view.slot);
+
+        if (frameSlot->sequence.load(std::memory_order_acquire) != 2 * sequence) {
+            return false;
+        }
+
+        view.sequence = sequence;
+        view.data = reinterpret_cast<const unsigned char *>(frameSlot) + SHARED_FRAME_SLOT_HEADER_SIZE;
+        view.width = frameSlot->width;
+        view.height = frameSlot->height;
+        view.rowBytes = frameSlot->rowBytes;
+        view.pixelFormat = frameSlot->pixelFormat;
+        view.cropX = frameSlot->cropX;
+        view.cropY = frameSlot->cropY;
+        view.cropWidth = frameSlot->cropWidth;
+        view.cropHeight = frameSlot->cropHeight;
+        view.frameIndex = frameSlot->frameIndex;
+        view.timestamp = frameSlot->timestamp;
+
+        return validate(view);
+    }
+
+    /**
+     * Get a view on the most recent complete frame
+     */
+    bool acquireLatest(sharedFrameView &view) const { return acquire(lastSequence(), view); }
+
+    /**
+     * @return true if the frame of view has not been overwritten since it was acquired
+     */
+    bool validate(const sharedFrameView &view) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header != nullptr && slotAt(view.slot)->sequence.load(std::memory_order_relaxed) == 2 * view.sequence;
+    }
+};
+
+#endif  //_sharedFrameRingClient_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
@@ -0,0 +1,120 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file videoProbeCache.h
+ * @brief Metadata of the video files kept per path, size and modification time, with what is costly to compute on them.
+ *
+ * The capture of a video is opened on every \c set \c video anyway, reading the container properties from it is
+ * cheap. What a cache hit saves is the decode of the first frame for containers that do not tell the frame size,
+ * the measure of the keyframe interval (see gopReader::measureKeyframeInterval()) and the contact sheet.
+ * The least recently used videos are dropped beyond VIDEO_PROBE_CACHE_ENTRIES, and their contact sheets beyond
+ * VIDEO_PROBE_CACHE_PREVIEWS.
+ */
+
+#ifndef _videoProbeCache_H_
+#define _videoProbeCache_H_
+
+#include <ctime>
+#include <map>
+#include <string>
+
+#include <yarp/os/all.h>
+#include <opencv2/opencv.hpp>
+
+#define VIDEO_PROBE_CACHE_ENTRIES   256     // videos whose metadata are kept
+#define VIDEO_PROBE_CACHE_PREVIEWS  32      // contact sheets kept, about 0.7 MB each at the default layout
+
+struct videoInfo {
+    int width, height;
+    double fps;
+    int frameCount;
+    double duration;                // seconds
+
+    long long fileSize;             // identify the version of the file the metadata belong to
+    time_t modificationTime;
+
+    int keyframeInterval;           // frames, 0 until measured
+    cv::Mat preview;                // contact sheet, empty until generated
+};
+
+class videoProbeCache {
+private:
+    struct cachedVideo {
+        videoInfo info;
+        unsigned long long lastUse;     // value of useCount when last found or updated
+    };
+
+    std::map<std::string, cachedVideo> entries;
+    unsigned long long useCount;
+    yarp::os::Semaphore mutex;
+
+    /**
+     * Drop the least recently used entries, or only their previews, beyond the limits. Called with mutex held
+     */
+    void evict();
+
+    /**
+     * Read size and modification time of a file
+     * @return false if the file does not exist
+     */
+    static bool fileVersion(const std::string &path, long long &fileSize, time_t &modificationTime);
+
+    /**
+     * Apply update to the entry of a video, if the file did not change since it was probed
+     * @return false if there is no such entry
+     */
+    template <class Update>
+    bool updateEntry(const std::string &path, Update update);
+
+public:
+    videoProbeCache();
+
+    /**
+     * Get the metadata of a video, from the cache if the file did not change, from the container otherwise.
+     * On a miss the first frame is decoded only if the container gives no frame size.
+     * @param path path of the video
+     * @param capture capture opened on path, only read on a cache miss, left on the first frame
+     * @param info filled with the metadata
+     * @return false if the frame size cannot be known
+     */
+    bool probe(const std::string &path, cv::VideoCapture &capture, videoInfo &info);
+
+    /**
+     * Get the cached metadata of a video, if the file did not change since
+     * @return false on a cache miss
+     */
+    bool find(const std::string &path, videoInfo &info);
+
+    /**
+     * Store the preview of a video already probed
+     * @return false if the video is not in the cache or changed since it was probed
+     */
+    bool setPreview(const std::string &path, const cv::Mat &preview);
+
+    /**
+     * Store the keyframe interval of a video already probed
+     * @return false if the video is not in the cache or changed since it was probed
+     */
+    bool setKeyframeInterval(const std::string &path, int interval);
+};
+
+#endif  //_videoProbeCache_H_
+
+//----- end-of-file --- ( next line intentionally left blank ) ------------------
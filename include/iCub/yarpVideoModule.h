@@ -61,6 +61,54 @@
  * - \c config  \n
  *   specifies the name of the script that will be used
  *
+ * - \c clock  \n
+ *   name of a clock port (e.g. \c /clock of a simulator); when given, playback is paced on that network clock
+ *
+ * - \c local  \n
+ *   run on a local-mode yarp network, without a yarpserver (ports are only reachable from the same process)
+ *
+ * - \c speed \c 1.0 \n
+ *   playback speed factor, between 0.25 and 16, negative to play backwards
+ *
+ * - \c previewFPS \c 5 \n
+ *   maximum rate of the \c /videoPreview:o port
+ *
+ * - \c frameServerChunk \c 0 \n
+ *   frames decoded at once to answer the requests of \c /frame:rpc, 0 for the keyframe interval of the video
+ *
+ * - \c frameServerCache \c 2 \n
+ *   chunks of frames kept in memory by \c /frame:rpc
+ *
+ * - \c frameServerMemory \c 256 \n
+ *   megabytes the chunks of \c /frame:rpc may hold, the chunk size is reduced to fit
+ *
+ * - \c previewColumns \c 4, \c previewRows \c 4, \c previewWidth \c 160 \n
+ *   layout of the contact sheets returned by \c get \c preview on \c /frame:rpc, width of a thumbnail in pixels
+ *
+ * - \c previewBudget \c 0.1 \n
+ *   fraction of a core the background preview generation may use
+ *
+ * - \c readAhead \c 0 \n
+ *   megabytes of the video file read ahead of the decoder by a separate thread, 0 to disable
+ *
+ * - \c unpaced  \n
+ *   send every frame of the video as fast as possible, for offline consumers
+ *
+ * - \c batch \c 0 \n
+ *   number of consecutive frames sent in each message of the \c /videoBatch:o port, 0 for no such port
+ *
+ * - \c skipUnchanged \c -1 \n
+ *   mean absolute difference per channel under which a frame equal to the previous one is not sent, negative to send all
+ *
+ * - \c skipRefresh \c 1.0 \n
+ *   seconds after which a frame is sent even if unchanged
+ *
+ * - \c reverseChunk \c 0 \n
+ *   frames decoded at once when playing backwards, 0 for the keyframe interval of the video
+ *
+ * - \c reverseMemory \c 512 \n
+ *   megabytes the two chunks held when playing backwards may take, the chunk size is reduced to fit
+ *
  *
  * <b>Configuration File Parameters</b>
  *
@@ -139,18 +187,24 @@
 
 // general command vocab's
 #define COMMAND_VOCAB_OK                 VOCAB2('o','k')
+#define COMMAND_VOCAB_IO                 VOCAB2('i','o')
 
 #define COMMAND_VOCAB_SET                VOCAB3('s','e','t')
 #define COMMAND_VOCAB_GET                VOCAB3('g','e','t')
 #define COMMAND_VOCAB_RUN                VOCAB3('r','u','n')
 #define COMMAND_VOCAB_SUSPEND            VOCAB3('s','u','s')
 #define COMMAND_VOCAB_RES                VOCAB3('r','e','s')
+#define COMMAND_VOCAB_ROI                VOCAB3('r','o','i')
 #define COMMAND_VOCAB_FPS                VOCAB3('f','p','s')
 
 #define COMMAND_VOCAB_VIDEO              VOCAB4('v','i','d','e')
 #define COMMAND_VOCAB_HELP               VOCAB4('h','e','l','p')
 #define COMMAND_VOCAB_FAILED             VOCAB4('f','a','i','l')
 #define COMMAND_VOCAB_CROP               VOCAB4('c','r','o','p')
+#define COMMAND_VOCAB_SPEED              VOCAB4('s','p','e','e')
+#define COMMAND_VOCAB_STATS              VOCAB4('s','t','a','t')
+#define COMMAND_VOCAB_SEEK               VOCAB4('s','e','e','k')
+#define COMMAND_VOCAB_SKIP               VOCAB4('s','k','i','p')
 
 
 class yarpVideoModule:public yarp::os::RFModule {
@@ -32,6 +32,7 @@
 #include <yarp/dev/all.h>
 #include <yarp/os/RateThread.h>
 #include <yarp/os/Log.h>
+#include <atomic>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -39,6 +40,22 @@
 #include <opencv2/opencv.hpp>
 #include <chrono>
 
+#include "sharedFrameRing.h"
+#include "playbackStatistics.h"
+#include "reverseFrameBuffer.h"
+#include "roiPublisher.h"
+#include "frameBatch.h"
+#include "deliveryChannel.h"
+#include "frameServer.h"
+#include "readAheadStream.h"
+#include "videoProbeCache.h"
+#include "previewGenerator.h"
+
+#define MIN_PLAYBACK_SPEED 0.25
+#define MAX_PLAYBACK_SPEED 16.0
+#define DEFAULT_SOURCE_FPS 25.0
+#define MIN_GRABBED_GAP 30          // forward gaps up to this many frames are grabbed rather than seeked
+
 class yarpVideoRateThread : public yarp::os::RateThread {
 private:
     bool result;                    //result of the processing
@@ -51,16 +68,62 @@ private:
 
     yarp::os::BufferedPort<yarp::sig::ImageOf<yarp::sig::PixelBgr> > outputVideoPort;
     yarp::os::BufferedPort<yarp::os::Bottle> inputYarpviewClickPort;
-
-    IplImage *iplCropFrme;
-    IplImage *temporaryIplFrame;
+    yarp::os::BufferedPort<yarp::os::Bottle> frameDescriptorPort;  // descriptors of the frames in frameRing
+    yarp::os::BufferedPort<yarp::os::Bottle> repeatFramePort;      // announces the frames not sent because unchanged
+    yarp::os::BufferedPort<frameBatch> batchPort;                  // batchSize frames per message
+
+    // Shared memory output for consumers on the same host
+    sharedFrameRing frameRing;
+    std::string sharedMemoryName;   // empty when the shared memory output is disabled
+    int sharedMemorySlots;
+
+    playbackStatistics statistics;  // timing of the frames sent, see getStatistics()
+    yarp::os::Stamp frameStamp;     // envelope of the frames sent on /video:o
+    yarp::os::Stamp publishStamp;   // envelope of the frames sent on the roi and delivery channel ports
+    roiPublisher roiOutputs;        // named regions of interest, each on its own port
+
+    // Outputs with their own delivery policy, so that slow subscribers do not hold the others
+    deliveryChannel previewChannel; // rate capped, latest frame only
+    deliveryChannel latestChannel;  // latest frame only
+
+    // Offline consumers
+    bool unpaced;                   // send every frame as fast as possible, without following any clock
+    int batchSize;                  // frames per message on batchPort, 0 to disable it
+    frameBatch *pendingBatch;       // batch being filled, nullptr if none
+
+    // Unchanged frames detection
+    double skipThreshold;           // mean absolute difference per channel under which a frame is not sent, negative to send all
+    double skipRefresh;             // a frame is sent at least every skipRefresh seconds
+    double lastSentTime;
+    cv::Mat lastSentFrame;          // copy of the last frame sent on /video:o
 
     // Parameters video
-    yarp::sig::ImageOf<yarp::sig::PixelBgr> *processingRgbImageBis;
     std::unique_ptr<cv::VideoCapture> m_capVideo;
-    double videoFPS, readingTimeFrame;
-    std:: string videoPath;
-    bool changedVideo, cropVideo;
+    cv::Ptr<readAheadStream> readAhead;     // read ahead of the video file, empty if disabled
+    yarp::os::Semaphore readAheadMutex;     // readAhead is replaced by the video thread while rpc reads it
+    size_t readAheadBytes;
+    cv::Mat temporaryFrameHolder;   // last decoded frame
+    int decodedFrameIndex;          // index of the frame held in temporaryFrameHolder, -1 if none
+    int nextCaptureIndex;           // index of the frame the next grab will return
+    bool frameFromReverseBuffer;    // temporaryFrameHolder shares its pixels with reverseBuffer
+    double videoFPS;
+    videoProbeCache probeCache;     // metadata of the videos already played
+    double sourceFPS;               // fps of the video file
+    int videoFrameCount;            // number of frames announced by the video file
+    std::atomic<double> playbackSpeed;  // rate at which the video time advances, relative to yarp::os::Time, negative backwards
+    std::atomic<double> seekRequest;    // video time in seconds to jump to, negative if none
+    reverseFrameBuffer reverseBuffer;   // source of the frames when playing backwards
+    frameServer frameRequests;      // single frames on request, on its own port and capture
+    previewGenerator previews;      // contact sheets of the videos, built in background
+    std::string videoPath;              // video loaded, only used by the video thread
+
+    // video requested by rpc, taken by the video thread at the next switchVideo()
+    yarp::os::Semaphore videoPathMutex;
+    std::string requestedVideoPath;
+    double videoChangeTime;             // time of the last setVideoPath()
+    std::atomic<bool> changedVideo;
+
+    bool cropVideo;
     int widthInputVideo, heightInputVideo;
 
 private:
@@ -115,10 +178,25 @@ public:
     void setInputPortName(std::string inpPrtName);
 
     /**
-     * Set the member varibale videoFPS
+     * Set the member varibale videoFPS, the rate at which frames are sent
      * @param t_fps
+     * @return false if t_fps is not positive
      */
-    void setVideoFPS(double t_fps);
+    bool setVideoFPS(double t_fps);
+
+    /**
+     * Set the playback speed factor, e.g. 2 plays the video twice as fast as recorded, -1 plays it backwards
+     * @param t_speed factor whose magnitude is in [MIN_PLAYBACK_SPEED, MAX_PLAYBACK_SPEED]
+     * @return false if the factor is out of range
+     */
+    bool setPlaybackSpeed(double t_speed);
+
+    /**
+     * Jump to a position of the video, playback goes on from there in the current direction
+     * @param t_seconds video time
+     * @return false if t_seconds is negative
+     */
+    bool seekVideo(double t_seconds);
 
     /**
      * set the member variable videoPath
@@ -129,16 +207,16 @@ public:
     // Processing functions
 
     /**
-     * Load video by extrating all frames and saved them into /tmp directory
-     * @return
+     * Open the video and read its metadata, a frame is decoded only if the container does not tell the size
+     * and the file was not probed before
+     * @return false if the video cannot be opened
      */
     bool loadVideo();
 
     /**
-     * Calcul in seconds how long it's take to extract a frame from the VideoCapture object
-     * @return
+     * Load the video requested by setVideoPath(), called by the video thread
      */
-    double computeReadingTime();
+    void switchVideo();
 
     /**
      * From the Point(x1,y1) and Point(x2,y2) compute the rectangle Area
@@ -150,6 +228,83 @@ public:
      */
     bool computeCropArea(int x1, int x2, int y1, int y2);
 
+    /**
+     * Bring the frame frameIndex into temporaryFrameHolder, skipping the frames in between with grab()
+     * @param frameIndex index of the wanted frame in the video
+     * @return false at the end of the video
+     */
+    bool seekFrame(int frameIndex);
+
+    /**
+     * Send a frame, cropped if required, on the output port
+     * @param frame decoded frame
+     */
+    void publishFrame(const cv::Mat &frame);
+
+    /**
+     * Copy the full frame in the shared memory ring and announce it on the descriptor port
+     * @param frame decoded frame
+     */
+    void shareFrame(const cv::Mat &frame);
+
+    /**
+     * Compare a frame with the last one sent on /video:o
+     * @param frame output frame, cropped if required
+     * @return true if the frame can be skipped
+     */
+    bool isUnchangedFrame(const cv::Mat &frame);
+
+    /**
+     * Append a frame to the pending batch, the batch is sent once batchSize frames are in
+     * @param frame output frame, cropped if required
+     */
+    void batchFrame(const cv::Mat &frame);
+
+    /**
+     * Send the pending batch, even if not full
+     */
+    void flushBatch();
+
+    /**
+     * Set the threshold under which frames are not sent
+     * @param t_threshold mean absolute difference per channel (0-255), negative to send every frame
+     */
+    void setSkipThreshold(double t_threshold);
+
+    /**
+     * @return true if someone is listening to the video, through the port or the shared memory
+     */
+    bool hasSubscribers();
+
+    /**
+     * Fill reply with the achieved fps and jitter of /video:o, frames sent and repeated, dropped ticks, output size and video switch time
+     * @param reply bottle to fill
+     */
+    void getStatistics(yarp::os::Bottle &reply);
+
+    /**
+     * Fill reply with (fill f) (stalls n) (refills r) (mode stream|cache) of the read ahead of the video file
+     * @return false if the read ahead is disabled
+     */
+    bool getReadAheadStatus(yarp::os::Bottle &reply);
+
+    /**
+     * Add a named region of interest sent on <name>/roi/<roiName>:o, or move an existing one
+     * @return false if the name or the area is not valid
+     */
+    bool setRoi(const std::string &roiName, int x1, int y1, int x2, int y2);
+
+    /**
+     * Remove a region of interest and close its port
+     * @return false if there is no such region
+     */
+    bool removeRoi(const std::string &roiName);
+
+    /**
+     * Fill reply with a list (name x1 y1 x2 y2) per region of interest
+     */
+    void getRois(yarp::os::Bottle &reply);
+
 
     void setCropVideo(bool cropVideo);
 
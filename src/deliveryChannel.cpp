@@ -0,0 +1,95 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file deliveryChannel.cpp
+ * @brief Implementation of the per subscriber output port (see deliveryChannel.h).
+ */
+
+#include "../include/iCub/deliveryChannel.h"
+
+using namespace yarp::os;
+
+deliveryChannel::deliveryChannel(double t_maxRate) : minPeriod(t_maxRate > 0 ? 1.0 / t_maxRate : 0.0),
+                                                     lastSentTime(0.0), framesDropped(0) {
+    // rows of the decoded frames are not padded
+    image.setQuantum(1);
+}
+
+bool deliveryChannel::open(const std::string &name) {
+    port.enableBackgroundWrite(true);
+    return port.open(name);
+}
+
+bool deliveryChannel::offer(const cv::Mat &frame, Stamp &stamp) {
+    if (port.getOutputCount() == 0) {
+        return false;
+    }
+
+    const double now = Time::now();
+    if (minPeriod > 0 && now - lastSentTime < minPeriod) {
+        return false;
+    }
+
+    // latest only: nothing is queued behind a frame still on its way
+    if (port.isWriting()) {
+        ++framesDropped;
+        return false;
+    }
+
+    // a crop is not contiguous in memory, only then the pixels are copied
+    inFlight = frame.isContinuous() ? frame : frame.clone();
+    image.setExternal(inFlight.data, inFlight.cols, inFlight.rows);
+
+    port.setEnvelope(stamp);
+    port.write(image);
+    lastSentTime = now;
+
+    return true;
+}
+
+bool deliveryChannel::isSending(const cv::Mat &frame) {
+    if (inFlight.empty()) {
+        return false;
+    }
+
+    if (!port.isWriting()) {
+        inFlight.release();
+        return false;
+    }
+
+    return inFlight.datastart == frame.datastart;
+}
+
+bool deliveryChannel::hasSubscribers() {
+    return port.getOutputCount() > 0;
+}
+
+int deliveryChannel::getFramesDropped() const {
+    return framesDropped;
+}
+
+void deliveryChannel::interrupt() {
+    port.interrupt();
+}
+
+void deliveryChannel::close() {
+    port.close();
+    inFlight.release();
+}
@@ -0,0 +1,144 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file frameBatch.cpp
+ * @brief Implementation of the multi-frame message (see frameBatch.h).
+ */
+
+#include "../include/iCub/frameBatch.h"
+
+using namespace yarp::os;
+
+frameBatch::frameBatch() : width(0), height(0) {
+}
+
+size_t frameBatch::frameBytes() const {
+    return static_cast<size_t>(width) * height * 3;
+}
+
+void frameBatch::reset(int t_width, int t_height, int t_capacity) {
+    width = t_width;
+    height = t_height;
+    timestamps.clear();
+    frameIndexes.clear();
+
+    // growing only, so that a reused batch does not pay for clearing its memory again
+    const size_t capacityBytes = frameBytes() * (t_capacity > 0 ? t_capacity : 0);
+    if (pixels.size() < capacityBytes) {
+        pixels.resize(capacityBytes);
+    }
+}
+
+bool frameBatch::append(const cv::Mat &frame, int frameIndex, double timestamp) {
+    if (frame.cols != width || frame.rows != height || frame.type() != CV_8UC3) {
+        return false;
+    }
+
+    const size_t offset = timestamps.size() * frameBytes();
+    if (pixels.size() < offset + frameBytes()) {
+        pixels.resize(offset + frameBytes());
+    }
+
+    cv::Mat destination(height, width, CV_8UC3, pixels.data() + offset);
+    frame.copyTo(destination);
+
+    timestamps.push_back(timestamp);
+    frameIndexes.push_back(frameIndex);
+    return true;
+}
+
+int frameBatch::size() const {
+    return static_cast<int>(timestamps.size());
+}
+
+int frameBatch::getWidth() const {
+    return width;
+}
+
+int frameBatch::getHeight() const {
+    return height;
+}
+
+cv::Mat frameBatch::getFrame(int i) {
+    return cv::Mat(height, width, CV_8UC3, pixels.data() + i * frameBytes());
+}
+
+double frameBatch::getTimestamp(int i) const {
+    return timestamps[i];
+}
+
+int frameBatch::getFrameIndex(int i) const {
+    return frameIndexes[i];
+}
+
+bool frameBatch::read(ConnectionReader &connection) {
+    connection.convertTextMode();
+
+    if (connection.expectInt() != FRAME_BATCH_VERSION) {
+        return false;
+    }
+
+    const int count = connection.expectInt();
+    const int t_width = connection.expectInt();
+    const int t_height = connection.expectInt();
+    if (connection.isError() || count < 0 || t_width < 0 || t_height < 0 || count > FRAME_BATCH_MAX_FRAMES ||
+        t_width > FRAME_BATCH_MAX_SIDE || t_height > FRAME_BATCH_MAX_SIDE ||
+        static_cast<long long>(count) * t_width * t_height * 3 > FRAME_BATCH_MAX_BYTES) {
+        return false;
+    }
+
+    reset(t_width, t_height, count);
+    timestamps.resize(static_cast<size_t>(count));
+    frameIndexes.resize(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        timestamps[i] = connection.expectDouble();
+        frameIndexes[i] = connection.expectInt();
+    }
+    if (connection.isError()) {
+        return false;
+    }
+
+    const size_t batchBytes = count * frameBytes();
+    if (batchBytes > 0 && !connection.expectBlock(reinterpret_cast<const char *>(pixels.data()), batchBytes)) {
+        return false;
+    }
+
+    return !connection.isError();
+}
+
+bool frameBatch::write(ConnectionWriter &connection) {
+    connection.appendInt(FRAME_BATCH_VERSION);
+    connection.appendInt(size());
+    connection.appendInt(width);
+    connection.appendInt(height);
+
+    for (int i = 0; i < size(); ++i) {
+        connection.appendDouble(timestamps[i]);
+        connection.appendInt(frameIndexes[i]);
+    }
+
+    // the pixels are not copied by the port, the batch stays untouched until it is sent
+    const size_t batchBytes = size() * frameBytes();
+    if (batchBytes > 0) {
+        connection.appendExternalBlock(reinterpret_cast<const char *>(pixels.data()), batchBytes);
+    }
+
+    return !connection.isError();
+}
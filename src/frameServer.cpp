@@ -0,0 +1,171 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file frameServer.cpp
+ * @brief Implementation of the random access frame server (see frameServer.h).
+ */
+
+#include "../include/iCub/frameServer.h"
+
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace std;
+
+frameServer::frameServer(videoProbeCache &t_probeCache, int t_chunkSize, int t_cacheCapacity, int t_memoryMegabytes) :
+        videoGeneration(0), probeCache(t_probeCache), servedGeneration(0), fixedChunkSize(t_chunkSize > 0 ? t_chunkSize : 0), chunkSize(0),
+        cacheCapacity(t_cacheCapacity > 0 ? t_cacheCapacity : 1),
+        memoryBytes(static_cast<size_t>(t_memoryMegabytes > 0 ? t_memoryMegabytes : 1) * 1024 * 1024),
+        previews(nullptr) {
+}
+
+void frameServer::setPreviewSource(previewGenerator *t_previews) {
+    this->previews = t_previews;
+}
+
+bool frameServer::open(const std::string &name) {
+    port.setReader(*this);
+    return port.open(name);
+}
+
+void frameServer::setVideo(const std::string &path) {
+    videoMutex.wait();
+    videoPath = path;
+    ++videoGeneration;
+    videoMutex.post();
+}
+
+bool frameServer::getFrame(int index, cv::Mat &frame) {
+    if (index < 0) {
+        return false;
+    }
+
+    bool found = false;
+
+    mutex.wait();
+
+    videoMutex.wait();
+    const unsigned int generation = videoGeneration;
+    const string path = videoPath;
+    videoMutex.post();
+
+    // the video is opened on the first request only, most videos are never asked for a single frame
+    if (generation != servedGeneration) {
+        servedGeneration = generation;
+        chunks.clear();
+        chunkIndex.clear();
+        reader.open(path);
+
+        videoInfo info;
+        chunkSize = fixedChunkSize;
+        if (chunkSize == 0 && probeCache.find(path, info) && info.keyframeInterval > 0) {
+            chunkSize = info.keyframeInterval;
+        } else if (chunkSize == 0) {
+            chunkSize = reader.measureKeyframeInterval();
+            probeCache.setKeyframeInterval(path, chunkSize);
+        }
+        chunkSize = reader.fitChunk(chunkSize, memoryBytes, static_cast<int>(cacheCapacity) + 1);
+    }
+
+    // no video yet
+    if (chunkSize == 0) {
+        mutex.post();
+        return false;
+    }
+
+    const int chunkFirst = index / chunkSize * chunkSize;
+
+    auto cached = chunkIndex.find(chunkFirst);
+    if (cached != chunkIndex.end()) {
+        chunks.splice(chunks.begin(), chunks, cached->second);
+    } else {
+        vector<cv::Mat> frames;
+        reader.decode(chunkFirst, chunkSize, frames);
+
+        chunks.emplace_front(chunkFirst, std::move(frames));
+        chunkIndex[chunkFirst] = chunks.begin();
+
+        if (chunks.size() > cacheCapacity) {
+            chunkIndex.erase(chunks.back().first);
+            chunks.pop_back();
+        }
+    }
+
+    const vector<cv::Mat> &frames = chunks.front().second;
+    const size_t offset = static_cast<size_t>(index - chunkFirst);
+    if (offset < frames.size()) {
+        frame = frames[offset];
+        found = true;
+    }
+
+    mutex.post();
+
+    return found;
+}
+
+bool frameServer::read(ConnectionReader &connection) {
+    Bottle command;
+    if (!command.read(connection)) {
+        return false;
+    }
+
+    ImageOf<PixelBgr> reply;
+
+    cv::Mat frame;
+    cv::Rect area;
+
+    if (command.get(0).asString() == "get" && command.get(1).asString() == "frame" &&
+        getFrame(command.get(2).asInt(), frame)) {
+
+        area = cv::Rect(0, 0, frame.cols, frame.rows);
+        if (command.size() >= 7) {
+            const int x1 = command.get(3).asInt();
+            const int y1 = command.get(4).asInt();
+            const int x2 = command.get(5).asInt();
+            const int y2 = command.get(6).asInt();
+            area = area & cv::Rect(x1, y1, x2 - x1, y2 - y1);
+        }
+    } else if (command.get(0).asString() == "get" && command.get(1).asString() == "preview" && previews != nullptr &&
+               previews->getPreview(command.get(2).asString(), frame)) {
+        area = cv::Rect(0, 0, frame.cols, frame.rows);
+    }
+
+    if (area.area() > 0) {
+        reply.resize(area.width, area.height);
+        cv::Mat replyBuffer(area.height, area.width, CV_8UC3, reply.getRawImage(),
+                            static_cast<size_t>(reply.getRowSize()));
+        frame(area).copyTo(replyBuffer);
+    }
+
+    ConnectionWriter *writer = connection.getWriter();
+    if (writer != nullptr) {
+        reply.write(*writer);
+    }
+
+    return true;
+}
+
+void frameServer::interrupt() {
+    port.interrupt();
+}
+
+void frameServer::close() {
+    port.close();
+    reader.release();
+}
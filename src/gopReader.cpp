@@ -0,0 +1,252 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file gopReader.cpp
+ * @brief Implementation of the group of pictures decoder (see gopReader.h).
+ */
+
+#include "../include/iCub/gopReader.h"
+
+#include <algorithm>
+
+#define KEYFRAMES_SCANNED   4       // intervals looked at in the raw packets
+#define TIMED_READS         9       // sequential reads timing the decode of a frame
+#define TIMED_SEEKS         8       // seeks spread over MAX_KEYFRAME_INTERVAL frames
+
+gopReader::gopReader() : nextIndex(0), measureStep(-1), measuredInterval(1), frameTime(0.0) {
+}
+
+bool gopReader::open(const std::string &path) {
+    release();
+    videoPath = path;
+    nextIndex = 0;
+
+    return capture.open(videoPath);
+}
+
+void gopReader::release() {
+    if (capture.isOpened()) {
+        capture.release();
+    }
+}
+
+bool gopReader::isOpened() const {
+    return capture.isOpened();
+}
+
+const std::string &gopReader::getPath() const {
+    return videoPath;
+}
+
+int gopReader::decode(int first, int count, std::vector<cv::Mat> &frames) {
+    frames.clear();
+
+    if (!capture.isOpened() || first < 0 || count <= 0) {
+        return 0;
+    }
+
+    if (first != nextIndex) {
+        capture.set(cv::CAP_PROP_POS_FRAMES, first);
+        nextIndex = first;
+    }
+
+    frames.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        cv::Mat frame;
+        if (!capture.read(frame) || frame.empty()) {
+            // end of the video, the position is unknown until the next seek
+            nextIndex = -1;
+            break;
+        }
+        frames.push_back(frame);
+        ++nextIndex;
+    }
+
+    return static_cast<int>(frames.size());
+}
+
+int gopReader::measureKeyframeInterval() {
+    beginKeyframeMeasure();
+    while (!stepKeyframeMeasure()) {
+    }
+
+    return measuredInterval;
+}
+
+void gopReader::beginKeyframeMeasure() {
+    measureStep = 0;
+    measuredInterval = 1;
+    frameTime = 0.0;
+}
+
+bool gopReader::stepKeyframeMeasure() {
+    if (measureStep < 0) {
+        return true;
+    }
+
+    if (!capture.isOpened()) {
+        return finishKeyframeMeasure(1);
+    }
+
+    // the capture is left anywhere, the next decode seeks
+    nextIndex = -1;
+
+    const int frameCount = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+
+    if (measureStep == 0) {
+        const int scanned = scanKeyframeInterval();
+        if (scanned > 0) {
+            return finishKeyframeMeasure(scanned);
+        }
+
+        if (frameCount <= TIMED_READS) {
+            return finishKeyframeMeasure(frameCount);
+        }
+
+        frameTime = timeFrameDecode();
+        if (frameTime <= 0) {
+            return finishKeyframeMeasure(1);
+        }
+
+        measureStep = 1;
+        return false;
+    }
+
+    // one timed seek per step, at uneven positions so that a regular interval does not put them all at the same
+    // distance from a keyframe
+    const int span = std::min(frameCount - 1, MAX_KEYFRAME_INTERVAL);
+    const int i = measureStep - 1;
+    const int position = std::min(1 + i * span / TIMED_SEEKS + i, frameCount - 1);
+
+    cv::Mat frame;
+    const int64 start = cv::getTickCount();
+    capture.set(cv::CAP_PROP_POS_FRAMES, position);
+    if (capture.read(frame)) {
+        const double decodedFrames = static_cast<double>(cv::getTickCount() - start) / frameTime;
+        measuredInterval = std::max(measuredInterval, static_cast<int>(decodedFrames + 0.5));
+    }
+
+    // the seeks rarely fall right before a keyframe, the margin keeps the chunks over the interval
+    if (++measureStep > TIMED_SEEKS) {
+        return finishKeyframeMeasure(measuredInterval + measuredInterval / 4);
+    }
+
+    return false;
+}
+
+int gopReader::getKeyframeInterval() const {
+    return measureStep < 0 ? measuredInterval : 0;
+}
+
+bool gopReader::finishKeyframeMeasure(int interval) {
+    measuredInterval = std::min(std::max(interval, 1), MAX_KEYFRAME_INTERVAL);
+    measureStep = -1;
+    return true;
+}
+
+bool gopReader::scanKeyframes(const std::string &path, std::vector<int> &keyframes) {
+    keyframes.clear();
+#ifdef GOP_READER_RAW_PACKETS
+    cv::VideoCapture packets(path, cv::CAP_FFMPEG, std::vector<int>{cv::CAP_PROP_FORMAT, -1});
+    if (!packets.isOpened()) {
+        return false;
+    }
+
+    cv::Mat packet;
+    for (int index = 0; packets.read(packet); ++index) {
+        if (packets.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0) {
+            keyframes.push_back(index);
+        }
+    }
+
+    return true;
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+int gopReader::scanKeyframeInterval() {
+#ifdef GOP_READER_RAW_PACKETS
+    cv::VideoCapture packets(videoPath, cv::CAP_FFMPEG, std::vector<int>{cv::CAP_PROP_FORMAT, -1});
+    if (!packets.isOpened()) {
+        return 0;
+    }
+
+    int interval = 0, lastKeyframe = -1, keyframes = 0;
+    cv::Mat packet;
+    int index = 0;
+    for (; index < MAX_KEYFRAME_INTERVAL * KEYFRAMES_SCANNED && packets.read(packet); ++index) {
+        if (packets.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) == 0) {
+            continue;
+        }
+
+        if (lastKeyframe >= 0) {
+            interval = std::max(interval, index - lastKeyframe);
+        }
+        lastKeyframe = index;
+
+        if (++keyframes > KEYFRAMES_SCANNED) {
+            break;
+        }
+    }
+
+    // a single keyframe: the video or the scanned part is one group of pictures
+    if (lastKeyframe >= 0 && keyframes == 1) {
+        interval = index - lastKeyframe;
+    }
+
+    return interval;
+#else
+    return 0;
+#endif
+}
+
+double gopReader::timeFrameDecode() {
+    // the first read also initialises the decoder
+    capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+    cv::Mat frame;
+    capture.read(frame);
+
+    std::vector<double> readTimes;
+    for (int i = 0; i < TIMED_READS; ++i) {
+        const int64 start = cv::getTickCount();
+        if (!capture.read(frame)) {
+            break;
+        }
+        readTimes.push_back(static_cast<double>(cv::getTickCount() - start));
+    }
+
+    if (readTimes.empty()) {
+        return 0.0;
+    }
+
+    // the median absorbs the more costly keyframes
+    std::nth_element(readTimes.begin(), readTimes.begin() + readTimes.size() / 2, readTimes.end());
+    return std::max(readTimes[readTimes.size() / 2], 1.0);
+}
+
+int gopReader::fitChunk(int frames, size_t memoryBytes, int chunksHeld) {
+    const size_t frameBytes = static_cast<size_t>(std::max(capture.get(cv::CAP_PROP_FRAME_WIDTH), 1.0) *
+                                                  std::max(capture.get(cv::CAP_PROP_FRAME_HEIGHT), 1.0) * 3);
+    const size_t fitting = memoryBytes / (static_cast<size_t>(std::max(chunksHeld, 1)) * frameBytes);
+
+    return static_cast<int>(std::max<size_t>(1, std::min(static_cast<size_t>(std::max(frames, 1)), fitting)));
+}
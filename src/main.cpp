@@ -17,6 +17,11 @@ int main(int argc, char *argv[]) {
     rf.setDefaultContext("yarpVideoPlayer");              //overridden by --context parameter
     rf.configure(argc, argv);
 
+    // ports stay in this process, no yarpserver required (e.g. for timing checks)
+    if (rf.check("local")) {
+        Network::setLocalMode(true);
+    }
+
 
     yInfo("resourceFinder: %s", rf.toString().c_str());
 
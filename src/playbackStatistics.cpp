@@ -0,0 +1,144 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file playbackStatistics.cpp
+ * @brief Implementation of the playback timing figures (see playbackStatistics.h).
+ */
+
+#include "../include/iCub/playbackStatistics.h"
+
+#include <cmath>
+
+using namespace yarp::os;
+
+playbackStatistics::playbackStatistics(size_t t_windowSize) : windowSize(t_windowSize), switchRequestTime(-1.0),
+                                                              switchDuration(0.0) {
+    reset();
+}
+
+void playbackStatistics::reset() {
+    mutex.wait();
+    frameTimes.clear();
+    framesSent = framesRepeated = ticksDropped = 0;
+    frameWidth = frameHeight = 0;
+    mutex.post();
+}
+
+void playbackStatistics::frameSent(double time, int width, int height) {
+    mutex.wait();
+    frameTimes.push_back(time);
+    if (frameTimes.size() > windowSize) {
+        frameTimes.pop_front();
+    }
+
+    ++framesSent;
+    frameWidth = width;
+    frameHeight = height;
+
+    if (switchRequestTime >= 0) {
+        switchDuration = time - switchRequestTime;
+        switchRequestTime = -1.0;
+    }
+    mutex.post();
+}
+
+void playbackStatistics::frameRepeated() {
+    mutex.wait();
+    ++framesRepeated;
+    mutex.post();
+}
+
+void playbackStatistics::ticksSkipped(int count) {
+    mutex.wait();
+    ticksDropped += count;
+    mutex.post();
+}
+
+void playbackStatistics::switchRequested(double time) {
+    mutex.wait();
+    switchRequestTime = time;
+    mutex.post();
+}
+
+double playbackStatistics::getFPS() {
+    mutex.wait();
+    double fps = 0.0;
+    if (frameTimes.size() > 1 && frameTimes.back() > frameTimes.front()) {
+        fps = (frameTimes.size() - 1) / (frameTimes.back() - frameTimes.front());
+    }
+    mutex.post();
+
+    return fps;
+}
+
+double playbackStatistics::getJitter() {
+    mutex.wait();
+    double jitter = 0.0;
+    if (frameTimes.size() > 2) {
+        const size_t intervals = frameTimes.size() - 1;
+        const double meanInterval = (frameTimes.back() - frameTimes.front()) / intervals;
+
+        double sumSquares = 0.0;
+        for (size_t i = 1; i < frameTimes.size(); ++i) {
+            const double deviation = (frameTimes[i] - frameTimes[i - 1]) - meanInterval;
+            sumSquares += deviation * deviation;
+        }
+        jitter = std::sqrt(sumSquares / intervals);
+    }
+    mutex.post();
+
+    return jitter;
+}
+
+void playbackStatistics::report(Bottle &reply) {
+    const double fps = getFPS();
+    const double jitter = getJitter();
+
+    mutex.wait();
+    Bottle &fpsEntry = reply.addList();
+    fpsEntry.addString("fps");
+    fpsEntry.addDouble(fps);
+
+    Bottle &jitterEntry = reply.addList();
+    jitterEntry.addString("jitter");
+    jitterEntry.addDouble(jitter);
+
+    Bottle &framesEntry = reply.addList();
+    framesEntry.addString("frames");
+    framesEntry.addInt(framesSent);
+
+    Bottle &repeatedEntry = reply.addList();
+    repeatedEntry.addString("repeated");
+    repeatedEntry.addInt(framesRepeated);
+
+    Bottle &droppedEntry = reply.addList();
+    droppedEntry.addString("dropped");
+    droppedEntry.addInt(ticksDropped);
+
+    Bottle &sizeEntry = reply.addList();
+    sizeEntry.addString("size");
+    sizeEntry.addInt(frameWidth);
+    sizeEntry.addInt(frameHeight);
+
+    Bottle &switchEntry = reply.addList();
+    switchEntry.addString("switch");
+    switchEntry.addDouble(switchDuration);
+    mutex.post();
+}
@@ -0,0 +1,210 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file previewGenerator.cpp
+ * @brief Implementation of the contact sheet job (see previewGenerator.h).
+ */
+
+#include "../include/iCub/previewGenerator.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <yarp/os/Log.h>
+
+#include "../include/iCub/gopReader.h"
+
+using namespace yarp::os;
+using namespace std;
+
+previewGenerator::previewGenerator(videoProbeCache &t_probeCache, int t_columns, int t_rows, int t_thumbnailWidth,
+                                   double t_cpuBudget) :
+        probeCache(t_probeCache), columns(std::max(t_columns, 1)), rows(std::max(t_rows, 1)),
+        thumbnailWidth(std::max(t_thumbnailWidth, 8)),
+        cpuBudget(t_cpuBudget > 0 && t_cpuBudget <= 1 ? t_cpuBudget : 0.1) {
+}
+
+bool previewGenerator::getPreview(const std::string &path, cv::Mat &sheet) {
+    videoInfo info;
+    if (probeCache.find(path, info) && !info.preview.empty()) {
+        sheet = info.preview;
+        return true;
+    }
+
+    lock_guard<std::mutex> lock(mutex);
+    if (std::find(pending.begin(), pending.end(), path) == pending.end()) {
+        // the front is being built, the oldest request waiting makes room
+        if (pending.size() >= PREVIEW_MAX_PENDING) {
+            pending.erase(pending.begin() + 1);
+        }
+        pending.push_back(path);
+        condition.notify_all();
+    }
+
+    return false;
+}
+
+bool previewGenerator::threadInit() {
+#ifdef __linux__
+    // niceness is per thread on linux, the playback thread keeps its priority
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+    return true;
+}
+
+void previewGenerator::run() {
+    while (!isStopping()) {
+        string path;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return !pending.empty() || isStopping(); });
+            if (isStopping()) {
+                break;
+            }
+            path = pending.front();
+        }
+
+        const cv::Mat sheet = buildContactSheet(path);
+        if (isStopping()) {
+            break;
+        }
+
+        if (sheet.empty() || !probeCache.setPreview(path, sheet)) {
+            yWarning("Unable to build the preview of %s", path.c_str());
+        }
+
+        lock_guard<std::mutex> lock(mutex);
+        pending.pop_front();
+    }
+}
+
+void previewGenerator::onStop() {
+    lock_guard<std::mutex> lock(mutex);
+    condition.notify_all();
+}
+
+double previewGenerator::threadTime() {
+#ifdef __linux__
+    timespec now;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) {
+        return now.tv_sec + now.tv_nsec * 1e-9;
+    }
+#endif
+    // not the time of a simulation, the budget is about the cpu
+    return SystemClock::nowSystem();
+}
+
+void previewGenerator::yieldBudget(double workStart) {
+    const double workTime = threadTime() - workStart;
+    SystemClock::delaySystem(workTime * (1.0 - cpuBudget) / cpuBudget);
+}
+
+void previewGenerator::downscale(const cv::Mat &frame, cv::Mat &tile) {
+    for (int y = 0; y < tile.rows; ++y) {
+        const int firstRow = y * frame.rows / tile.rows;
+        const int lastRow = std::max(firstRow + 1, (y + 1) * frame.rows / tile.rows);
+        unsigned char *output = tile.ptr(y);
+
+        for (int x = 0; x < tile.cols; ++x) {
+            const int firstColumn = x * frame.cols / tile.cols;
+            const int lastColumn = std::max(firstColumn + 1, (x + 1) * frame.cols / tile.cols);
+
+            unsigned int sum[3] = {0, 0, 0};
+            for (int row = firstRow; row < lastRow; ++row) {
+                const unsigned char *input = frame.ptr(row) + 3 * firstColumn;
+                for (int column = firstColumn; column < lastColumn; ++column, input += 3) {
+                    sum[0] += input[0];
+                    sum[1] += input[1];
+                    sum[2] += input[2];
+                }
+            }
+
+            const unsigned int area = static_cast<unsigned int>((lastRow - firstRow) * (lastColumn - firstColumn));
+            for (int channel = 0; channel < 3; ++channel) {
+                output[3 * x + channel] = static_cast<unsigned char>((sum[channel] + area / 2) / area);
+            }
+        }
+    }
+}
+
+cv::Mat previewGenerator::buildContactSheet(const std::string &path) {
+    double workStart = threadTime();
+
+#ifdef PREVIEW_SINGLE_THREAD_DECODE
+    cv::VideoCapture capture(path, cv::CAP_ANY, std::vector<int>{cv::CAP_PROP_N_THREADS, 1});
+#else
+    cv::VideoCapture capture(path);
+#endif
+    videoInfo info;
+    if (!capture.isOpened() || !probeCache.probe(path, capture, info) || info.frameCount <= 0) {
+        return cv::Mat();
+    }
+
+    const int thumbnails = columns * rows;
+
+    // at the keyframe nearest to each sample if there are enough of them, a seek elsewhere decodes up to it
+    std::vector<int> keyframes;
+    if (!gopReader::scanKeyframes(path, keyframes) || static_cast<int>(keyframes.size()) < thumbnails) {
+        keyframes.clear();
+    }
+    yieldBudget(workStart);
+    workStart = threadTime();
+
+    const int thumbnailHeight = std::max(1, thumbnailWidth * info.height / info.width);
+    cv::Mat sheet(rows * thumbnailHeight, columns * thumbnailWidth, CV_8UC3, cv::Scalar(0, 0, 0));
+
+    cv::Mat frame;
+
+    for (int i = 0; i < thumbnails && !isStopping(); ++i) {
+        // the middle of each of the intervals
+        int frameIndex = static_cast<int>((i + 0.5) * info.frameCount / thumbnails);
+        if (!keyframes.empty()) {
+            const auto after = std::lower_bound(keyframes.begin(), keyframes.end(), frameIndex);
+            const bool before = after != keyframes.begin() && (after == keyframes.end() ||
+                                                                frameIndex - *(after - 1) < *after - frameIndex);
+            if (before) {
+                frameIndex = *(after - 1);
+            } else {
+                frameIndex = *after;
+            }
+        }
+
+        capture.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+        if (!capture.read(frame) || frame.empty() || frame.type() != CV_8UC3) {
+            break;
+        }
+
+        cv::Mat tile = sheet(cv::Rect((i % columns) * thumbnailWidth, (i / columns) * thumbnailHeight,
+                                      thumbnailWidth, thumbnailHeight));
+        downscale(frame, tile);
+
+        yieldBudget(workStart);
+        workStart = threadTime();
+    }
+
+    return sheet;
+}
@@ -0,0 +1,222 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file readAheadStream.cpp
+ * @brief Implementation of the read ahead of the video file (see readAheadStream.h).
+ */
+
+#include "../include/iCub/readAheadStream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <yarp/os/Log.h>
+
+using namespace std;
+
+readAheadStream::readAheadStream(size_t bufferBytes, size_t chunkBytes) :
+        fd(-1), fileSize(0), chunkSize(chunkBytes > 0 ? chunkBytes : READ_AHEAD_CHUNK),
+        buffer(std::max(bufferBytes, chunkSize)), position(0), head(0), filled(0), generation(0),
+        endOfFile(false), readError(false), refilling(true), stalls(0), refills(0), streaming(false) {
+}
+
+readAheadStream::~readAheadStream() {
+    stop();
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool readAheadStream::open(const std::string &path, bool t_streaming) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        yError("Unable to open %s for read ahead", path.c_str());
+        return false;
+    }
+
+    struct stat fileStat;
+    fileSize = fstat(fd, &fileStat) == 0 ? static_cast<long long>(fileStat.st_size) : 0;
+    streaming = t_streaming;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    return start();
+}
+
+void readAheadStream::moveTo(long long offset) {
+    if (offset >= position && offset <= position + static_cast<long long>(filled)) {
+        const size_t skipped = static_cast<size_t>(offset - position);
+        head = (head + skipped) % buffer.size();
+        filled -= skipped;
+    } else {
+        head = 0;
+        filled = 0;
+        ++generation;
+        endOfFile = false;
+        readError = false;
+        refilling = true;
+    }
+
+    position = offset;
+    condition.notify_all();
+}
+
+long long readAheadStream::read(char *data, long long size) {
+    unique_lock<std::mutex> lock(mutex);
+
+    // waiting on the first read after a jump (probe of the container, seek, rewind) is not the read ahead lagging
+    if (filled == 0 && !endOfFile && !readError) {
+        ++(refilling ? refills : stalls);
+        condition.wait(lock, [this] { return filled > 0 || endOfFile || readError || isStopping(); });
+    }
+
+    long long copied = 0;
+    while (copied < size && filled > 0) {
+        const size_t count = std::min({static_cast<size_t>(size - copied), filled, buffer.size() - head});
+        memcpy(data + copied, buffer.data() + head, count);
+
+        head = (head + count) % buffer.size();
+        filled -= count;
+        position += count;
+        copied += count;
+    }
+
+    condition.notify_all();
+    return copied;
+}
+
+long long readAheadStream::seek(long long offset, int origin) {
+    lock_guard<std::mutex> lock(mutex);
+
+    long long target = offset;
+    if (origin == SEEK_CUR) {
+        target += position;
+    } else if (origin == SEEK_END) {
+        target += fileSize;
+    }
+
+    if (target < 0 || target > fileSize) {
+        return -1;
+    }
+
+    moveTo(target);
+    return target;
+}
+
+void readAheadStream::setDecodePosition(double fraction) {
+    const long long offset = static_cast<long long>(fraction * fileSize);
+
+    lock_guard<std::mutex> lock(mutex);
+    // the decoder passed the bytes read ahead: a stall only if it is within what the read ahead was asked for,
+    // further away or backwards it jumped and the ring refills
+    if ((offset < position || offset > position + static_cast<long long>(filled)) && !endOfFile && !readError) {
+        if (!refilling && offset <= position + static_cast<long long>(buffer.size())) {
+            ++stalls;
+        } else if (offset != position) {
+            ++refills;
+        }
+    }
+    moveTo(std::min(std::max(offset, 0LL), fileSize));
+}
+
+bool readAheadStream::isStreaming() const {
+    return streaming;
+}
+
+double readAheadStream::getFillLevel() {
+    lock_guard<std::mutex> lock(mutex);
+    return static_cast<double>(filled) / buffer.size();
+}
+
+int readAheadStream::getStalls() {
+    lock_guard<std::mutex> lock(mutex);
+    return stalls;
+}
+
+int readAheadStream::getRefills() {
+    lock_guard<std::mutex> lock(mutex);
+    return refills;
+}
+
+void readAheadStream::run() {
+    int failedReads = 0;
+
+    while (!isStopping()) {
+        size_t tail, count;
+        long long offset;
+        unsigned int readGeneration;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return isStopping() || (!endOfFile && !readError && filled < buffer.size()); });
+            if (isStopping()) {
+                break;
+            }
+
+            tail = (head + filled) % buffer.size();
+            count = std::min({chunkSize, buffer.size() - filled, buffer.size() - tail});
+            offset = position + filled;
+            readGeneration = generation;
+        }
+
+        // only this thread writes the free part of the ring, the decoder is not held during the read
+        const ssize_t bytesRead = pread(fd, buffer.data() + tail, count, static_cast<off_t>(offset));
+        const int readErrno = errno;
+
+        {
+            unique_lock<std::mutex> lock(mutex);
+            if (readGeneration != generation) {
+                failedReads = 0;
+                continue;   // the decoder jumped elsewhere meanwhile
+            }
+
+            if (bytesRead > 0) {
+                filled += static_cast<size_t>(bytesRead);
+                failedReads = 0;
+                refilling = false;
+            } else if (bytesRead == 0) {
+                endOfFile = true;
+            } else if (readErrno == EINTR) {
+                continue;
+            } else if ((readErrno == EAGAIN || readErrno == EIO) && ++failedReads < READ_AHEAD_RETRIES) {
+                // network storage hiccup: try again later, waiting longer each time
+                ++stalls;
+                condition.wait_for(lock, std::chrono::milliseconds(10 << failedReads), [this] { return isStopping(); });
+                continue;
+            } else {
+                yError("Read ahead of the video file failed at offset %lld: %s", offset, strerror(readErrno));
+                readError = true;
+            }
+        }
+        condition.notify_all();
+    }
+}
+
+void readAheadStream::onStop() {
+    lock_guard<std::mutex> lock(mutex);
+    condition.notify_all();
+}
@@ -0,0 +1,201 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file reverseFrameBuffer.cpp
+ * @brief Implementation of the backward frame buffer (see reverseFrameBuffer.h).
+ */
+
+#include "../include/iCub/reverseFrameBuffer.h"
+
+#include <yarp/os/Log.h>
+
+using namespace std;
+
+reverseFrameBuffer::reverseFrameBuffer(videoProbeCache &t_probeCache, int t_chunkSize, int t_memoryMegabytes) :
+        fixedChunkSize(t_chunkSize > 0 ? t_chunkSize : 0),
+        memoryBytes(static_cast<size_t>(t_memoryMegabytes > 0 ? t_memoryMegabytes : 1) * 1024 * 1024),
+        probeCache(t_probeCache), currentFirst(-1), currentSize(0), videoChanged(false), chunkSize(0),
+        measuring(false), requestedIndex(-1), decodingFirst(-1), decodingSize(0), prefetchedFirst(-1),
+        prefetchedSize(0) {
+}
+
+void reverseFrameBuffer::setVideo(const std::string &path) {
+    currentFirst = -1;
+    currentSize = 0;
+    currentFrames.clear();
+
+    lock_guard<std::mutex> lock(mutex);
+    videoPath = path;
+    videoChanged = true;
+    chunkSize = 0;
+    measuring = false;
+    requestedIndex = -1;
+    decodingFirst = -1;
+    prefetchedFirst = -1;
+    prefetchedFrames.clear();
+    condition.notify_all();
+}
+
+bool reverseFrameBuffer::inChunk(int first, int size, int index) {
+    return first >= 0 && index >= first && index < first + size;
+}
+
+bool reverseFrameBuffer::getFrame(int index, cv::Mat &frame) {
+    if (index < 0) {
+        return false;
+    }
+
+    if (currentFirst < 0 || index < currentFirst || index >= currentFirst + currentSize) {
+        unique_lock<std::mutex> lock(mutex);
+
+        // not prefetched (first backward frame, or a jump): have it decoded now, the worker knows the chunk size
+        if (!inChunk(prefetchedFirst, prefetchedSize, index) && !inChunk(decodingFirst, decodingSize, index)) {
+            requestedIndex = index;
+            condition.notify_all();
+        }
+
+        condition.wait(lock, [this, index] {
+            return inChunk(prefetchedFirst, prefetchedSize, index) || isStopping();
+        });
+        if (!inChunk(prefetchedFirst, prefetchedSize, index)) {
+            return false;
+        }
+
+        currentFrames.swap(prefetchedFrames);
+        currentFirst = prefetchedFirst;
+        currentSize = prefetchedSize;
+        prefetchedFirst = -1;
+        prefetchedFrames.clear();
+
+        // decode the chunk before while this one is played
+        if (currentFirst > 0) {
+            requestedIndex = currentFirst - 1;
+            condition.notify_all();
+        }
+    }
+
+    if (currentFrames.empty()) {
+        return false;
+    }
+
+    // the frame count of some containers is overestimated, the last decoded frame stands for the missing ones
+    const size_t offset = static_cast<size_t>(index - currentFirst);
+    frame = currentFrames[offset < currentFrames.size() ? offset : currentFrames.size() - 1];
+    return true;
+}
+
+void reverseFrameBuffer::openVideo(const std::string &path) {
+    if (!reader.open(path)) {
+        yError("Unable to open %s for backward playback", path.c_str());
+    }
+
+    videoInfo info;
+    int interval = fixedChunkSize;
+    if (interval == 0 && probeCache.find(path, info)) {
+        interval = info.keyframeInterval;
+    }
+
+    // until measured, chunks of a provisional size: playing backwards does not wait for the measure
+    const bool measure = interval == 0;
+    if (measure) {
+        reader.beginKeyframeMeasure();
+    }
+    const int size = reader.fitChunk(measure ? REVERSE_PROVISIONAL_CHUNK : interval, memoryBytes, 2);
+
+    lock_guard<std::mutex> lock(mutex);
+    if (!videoChanged) {
+        chunkSize = size;
+        measuring = measure;
+    }
+}
+
+void reverseFrameBuffer::run() {
+    while (!isStopping()) {
+        string path;
+        bool reopen = false;
+        int first = -1, size = 0;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return videoChanged || requestedIndex >= 0 || measuring || isStopping(); });
+            if (isStopping()) {
+                break;
+            }
+
+            if (videoChanged) {
+                reopen = true;
+                videoChanged = false;
+                path = videoPath;
+            } else if (requestedIndex >= 0) {
+                size = chunkSize;
+                first = requestedIndex / size * size;
+                requestedIndex = -1;
+                decodingFirst = first;
+                decodingSize = size;
+            }
+        }
+
+        if (reopen) {
+            openVideo(path);
+            continue;
+        }
+
+        // a step of the measure at most, the requests are served in between
+        if (first < 0) {
+            if (reader.stepKeyframeMeasure()) {
+                const int interval = reader.getKeyframeInterval();
+                probeCache.setKeyframeInterval(reader.getPath(), interval);
+
+                const int measuredSize = reader.fitChunk(fixedChunkSize > 0 ? fixedChunkSize : interval, memoryBytes, 2);
+                yInfo("Playing %s backwards by chunks of %d frames", reader.getPath().c_str(), measuredSize);
+
+                lock_guard<std::mutex> lock(mutex);
+                if (!videoChanged) {
+                    chunkSize = measuredSize;
+                    measuring = false;
+                }
+            }
+            continue;
+        }
+
+        vector<cv::Mat> frames;
+        reader.decode(first, size, frames);
+
+        {
+            lock_guard<std::mutex> lock(mutex);
+            // the video may have changed during the decode, these frames would belong to the previous one
+            if (!videoChanged) {
+                prefetchedFirst = first;
+                prefetchedSize = size;
+                prefetchedFrames.swap(frames);
+            }
+            decodingFirst = -1;
+        }
+        condition.notify_all();
+    }
+}
+
+void reverseFrameBuffer::onStop() {
+    lock_guard<std::mutex> lock(mutex);
+    condition.notify_all();
+}
+
+void reverseFrameBuffer::threadRelease() {
+    reader.release();
+}
@@ -0,0 +1,210 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file roiPublisher.cpp
+ * @brief Implementation of the regions of interest outputs (see roiPublisher.h).
+ */
+
+#include "../include/iCub/roiPublisher.h"
+
+#include <cctype>
+#include <vector>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace std;
+
+namespace {
+
+struct roiCopy {
+    cv::Mat source;                         // view of the roi in the decoded frame
+    ImageOf<PixelBgr> *image;               // prepared image of the roi port
+};
+
+/**
+ * Copies each roi in its prepared port image, one roi per stripe
+ */
+class roiCopyBody : public cv::ParallelLoopBody {
+private:
+    vector<roiCopy> &copies;
+
+public:
+    explicit roiCopyBody(vector<roiCopy> &t_copies) : copies(t_copies) {}
+
+    void operator()(const cv::Range &range) const override {
+        for (int i = range.start; i < range.end; ++i) {
+            roiCopy &copy = copies[i];
+            cv::Mat destination(copy.source.rows, copy.source.cols, CV_8UC3, copy.image->getRawImage(),
+                                static_cast<size_t>(copy.image->getRowSize()));
+            copy.source.copyTo(destination);
+        }
+    }
+};
+
+bool isValidRoiName(const string &name) {
+    if (name.empty()) {
+        return false;
+    }
+
+    for (char c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+void roiPublisher::setPortPrefix(const std::string &t_portPrefix) {
+    this->portPrefix = t_portPrefix;
+}
+
+bool roiPublisher::setRoi(const std::string &name, const cv::Rect &area) {
+    if (!isValidRoiName(name) || area.width <= 0 || area.height <= 0) {
+        return false;
+    }
+
+    mutex.wait();
+    const auto existing = rois.find(name);
+    if (existing != rois.end()) {
+        existing->second.area = area;
+        mutex.post();
+        return true;
+    }
+    mutex.post();
+
+    // the port is opened outside the lock, registration must not hold the video thread
+    unique_ptr<roiPort> port(new roiPort());
+    if (!port->open(portPrefix + name + ":o")) {
+        yError("Unable to open the port of roi %s", name.c_str());
+        return false;
+    }
+
+    mutex.wait();
+    roiOutput &output = rois[name];
+    output.area = area;
+    output.port = std::move(port);
+    mutex.post();
+
+    return true;
+}
+
+bool roiPublisher::removeRoi(const std::string &name) {
+    unique_ptr<roiPort> port;
+
+    mutex.wait();
+    const auto existing = rois.find(name);
+    if (existing != rois.end()) {
+        port = std::move(existing->second.port);
+        rois.erase(existing);
+    }
+    mutex.post();
+
+    if (!port) {
+        return false;
+    }
+
+    port->interrupt();
+    port->close();
+    return true;
+}
+
+void roiPublisher::listRois(Bottle &reply) {
+    mutex.wait();
+    for (const auto &roi : rois) {
+        Bottle &entry = reply.addList();
+        entry.addString(roi.first);
+        entry.addInt(roi.second.area.x);
+        entry.addInt(roi.second.area.y);
+        entry.addInt(roi.second.area.x + roi.second.area.width);
+        entry.addInt(roi.second.area.y + roi.second.area.height);
+    }
+    mutex.post();
+}
+
+bool roiPublisher::hasSubscribers() {
+    bool subscribed = false;
+
+    mutex.wait();
+    for (auto &roi : rois) {
+        if (roi.second.port->getOutputCount() > 0) {
+            subscribed = true;
+            break;
+        }
+    }
+    mutex.post();
+
+    return subscribed;
+}
+
+void roiPublisher::publish(const cv::Mat &frame, Stamp &stamp) {
+    vector<roiCopy> copies;
+    vector<roiPort *> ports;
+    const cv::Rect frameArea(0, 0, frame.cols, frame.rows);
+
+    mutex.wait();
+
+    for (auto &roi : rois) {
+        const cv::Rect area = roi.second.area & frameArea;
+        if (area.area() == 0 || roi.second.port->getOutputCount() == 0) {
+            continue;
+        }
+
+        ImageOf<PixelBgr> &image = roi.second.port->prepare();
+        image.resize(area.width, area.height);
+
+        roiCopy copy;
+        copy.source = frame(area);
+        copy.image = &image;
+        copies.push_back(copy);
+        ports.push_back(roi.second.port.get());
+    }
+
+    // a single pass over the decoded frame, the rois are copied concurrently
+    if (!copies.empty()) {
+        cv::parallel_for_(cv::Range(0, static_cast<int>(copies.size())), roiCopyBody(copies));
+    }
+
+    for (roiPort *port : ports) {
+        port->setEnvelope(stamp);
+        port->write();
+    }
+
+    mutex.post();
+}
+
+void roiPublisher::interrupt() {
+    mutex.wait();
+    for (auto &roi : rois) {
+        roi.second.port->interrupt();
+    }
+    mutex.post();
+}
+
+void roiPublisher::close() {
+    mutex.wait();
+    for (auto &roi : rois) {
+        roi.second.port->close();
+    }
+    rois.clear();
+    mutex.post();
+}
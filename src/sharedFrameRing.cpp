@@ -0,0 +1,167 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file sharedFrameRing.cpp
+ * @brief Implementation of the shared memory frame ring writer (see sharedFrameRing.h).
+ */
+
+#include "../include/iCub/sharedFrameRing.h"
+
+#include <new>
+#include <yarp/os/Log.h>
+
+static_assert(sizeof(sharedFrameSlot) <= SHARED_FRAME_SLOT_HEADER_SIZE, "slot header does not fit in its reserved space");
+
+#define RING_HEADER_SIZE 128u
+#define RING_ALIGNMENT   64u
+
+static_assert(sizeof(sharedFrameRingHeader) <= RING_HEADER_SIZE, "ring header does not fit in its reserved space");
+
+sharedFrameRing::sharedFrameRing() : mapping(nullptr), mappingSize(0), header(nullptr), sequence(0) {
+}
+
+sharedFrameRing::~sharedFrameRing() {
+    close();
+}
+
+bool sharedFrameRing::open(const std::string &name, unsigned int slotCount, size_t maxFrameBytes) {
+    close();
+    shmName = name;
+    sequence = 0;
+
+    return create(slotCount, maxFrameBytes);
+}
+
+bool sharedFrameRing::create(unsigned int slotCount, size_t maxFrameBytes) {
+    release();
+
+    // readers still mapping the old segment keep it alive, the name is free for the new one
+    shm_unlink(shmName.c_str());
+
+    const int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        yError("Unable to create the shared memory %s", shmName.c_str());
+        return false;
+    }
+
+    const size_t frameBytes = (maxFrameBytes + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+    const size_t slotSize = SHARED_FRAME_SLOT_HEADER_SIZE + frameBytes;
+    mappingSize = RING_HEADER_SIZE + slotCount * slotSize;
+
+    if (ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+        yError("Unable to allocate %zu bytes of shared memory for %s", mappingSize, shmName.c_str());
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        yError("Unable to map the shared memory %s", shmName.c_str());
+        mapping = nullptr;
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    // ftruncate zero fills the segment, so every slot starts with sequence 0 (empty)
+    header = new(mapping) sharedFrameRingHeader;
+    header->magic = SHARED_FRAME_RING_MAGIC;
+    header->version = SHARED_FRAME_RING_VERSION;
+    header->headerSize = RING_HEADER_SIZE;
+    header->slotCount = slotCount;
+    header->slotSize = slotSize;
+    header->maxFrameBytes = frameBytes;
+    header->lastSequence.store(sequence, std::memory_order_relaxed);
+    header->state.store(SHARED_FRAME_RING_ALIVE, std::memory_order_release);
+
+    yInfo("Sharing frames in %s: %u slots of %zu bytes", shmName.c_str(), slotCount, frameBytes);
+    return true;
+}
+
+void sharedFrameRing::release() {
+    if (mapping != nullptr) {
+        header->state.store(SHARED_FRAME_RING_CLOSED, std::memory_order_release);
+        munmap(mapping, mappingSize);
+    }
+
+    mapping = nullptr;
+    header = nullptr;
+    mappingSize = 0;
+}
+
+void sharedFrameRing::close() {
+    if (mapping != nullptr) {
+        release();
+        shm_unlink(shmName.c_str());
+    }
+}
+
+bool sharedFrameRing::isOpen() const {
+    return header != nullptr;
+}
+
+const std::string &sharedFrameRing::getName() const {
+    return shmName;
+}
+
+uint64_t sharedFrameRing::write(const cv::Mat &frame, int frameIndex, const cv::Rect &crop, double timestamp,
+                                unsigned int &slot) {
+    if (header == nullptr || frame.empty()) {
+        return 0;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(frame.cols) * frame.elemSize();
+    const size_t frameBytes = rowBytes * frame.rows;
+
+    if (frameBytes > header->maxFrameBytes && !create(header->slotCount, frameBytes)) {
+        return 0;
+    }
+
+    const uint64_t frameSequence = sequence + 1;
+    slot = static_cast<unsigned int>((frameSequence - 1) % header->slotCount);
+
+    unsigned char *slotAddress = static_cast<unsigned char *>(mapping) + header->headerSize + slot * header->slotSize;
+    sharedFrameSlot *frameSlot = reinterpret_cast<sharedFrameSlot *>(slotAddress);
+
+    frameSlot->sequence.store(2 * frameSequence - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    frameSlot->timestamp = timestamp;
+    frameSlot->width = static_cast<uint32_t>(frame.cols);
+    frameSlot->height = static_cast<uint32_t>(frame.rows);
+    frameSlot->rowBytes = static_cast<uint32_t>(rowBytes);
+    frameSlot->pixelFormat = SHARED_FRAME_PIXEL_BGR;
+    frameSlot->cropX = crop.x;
+    frameSlot->cropY = crop.y;
+    frameSlot->cropWidth = crop.width;
+    frameSlot->cropHeight = crop.height;
+    frameSlot->frameIndex = static_cast<uint64_t>(frameIndex);
+
+    cv::Mat slotFrame(frame.rows, frame.cols, frame.type(), slotAddress + SHARED_FRAME_SLOT_HEADER_SIZE, rowBytes);
+    frame.copyTo(slotFrame);
+
+    frameSlot->sequence.store(2 * frameSequence, std::memory_order_release);
+    header->lastSequence.store(frameSequence, std::memory_order_release);
+
+    sequence = frameSequence;
+    return sequence;
+}
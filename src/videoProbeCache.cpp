@@ -0,0 +1,164 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file videoProbeCache.cpp
+ * @brief Implementation of the video metadata cache (see videoProbeCache.h).
+ */
+
+#include "../include/iCub/videoProbeCache.h"
+
+#include <sys/stat.h>
+
+videoProbeCache::videoProbeCache() : useCount(0) {
+}
+
+bool videoProbeCache::fileVersion(const std::string &path, long long &fileSize, time_t &modificationTime) {
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0) {
+        return false;
+    }
+
+    fileSize = static_cast<long long>(fileStat.st_size);
+    modificationTime = fileStat.st_mtime;
+    return true;
+}
+
+bool videoProbeCache::find(const std::string &path, videoInfo &info) {
+    long long fileSize = 0;
+    time_t modificationTime = 0;
+    if (!fileVersion(path, fileSize, modificationTime)) {
+        return false;
+    }
+
+    bool found = false;
+
+    mutex.wait();
+    const auto entry = entries.find(path);
+    if (entry != entries.end() && entry->second.info.fileSize == fileSize &&
+        entry->second.info.modificationTime == modificationTime) {
+        info = entry->second.info;
+        entry->second.lastUse = ++useCount;
+        found = true;
+    }
+    mutex.post();
+
+    return found;
+}
+
+template <class Update>
+bool videoProbeCache::updateEntry(const std::string &path, Update update) {
+    long long fileSize = 0;
+    time_t modificationTime = 0;
+    if (!fileVersion(path, fileSize, modificationTime)) {
+        return false;
+    }
+
+    bool updated = false;
+
+    mutex.wait();
+    const auto entry = entries.find(path);
+    if (entry != entries.end() && entry->second.info.fileSize == fileSize &&
+        entry->second.info.modificationTime == modificationTime) {
+        update(entry->second.info);
+        entry->second.lastUse = ++useCount;
+        updated = true;
+        evict();
+    }
+    mutex.post();
+
+    return updated;
+}
+
+bool videoProbeCache::probe(const std::string &path, cv::VideoCapture &capture, videoInfo &info) {
+    if (find(path, info)) {
+        return true;
+    }
+
+    info.width = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH));
+    info.height = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT));
+    info.fps = capture.get(cv::CAP_PROP_FPS);
+    info.frameCount = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+    info.duration = info.fps > 0 ? info.frameCount / info.fps : 0.0;
+    info.keyframeInterval = 0;
+    info.preview.release();
+
+    // the container does not tell the frame size, the first frame does
+    if (info.width <= 0 || info.height <= 0) {
+        cv::Mat firstFrame;
+        capture >> firstFrame;
+        capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+
+        info.width = firstFrame.cols;
+        info.height = firstFrame.rows;
+    }
+
+    if (info.width <= 0 || info.height <= 0) {
+        return false;
+    }
+
+    // files that cannot be stat'ed (e.g. streams) are probed every time
+    if (fileVersion(path, info.fileSize, info.modificationTime)) {
+        mutex.wait();
+        cachedVideo &entry = entries[path];
+        entry.info = info;
+        entry.lastUse = ++useCount;
+        evict();
+        mutex.post();
+    }
+
+    return true;
+}
+
+bool videoProbeCache::setPreview(const std::string &path, const cv::Mat &preview) {
+    return updateEntry(path, [&preview](videoInfo &info) { info.preview = preview; });
+}
+
+bool videoProbeCache::setKeyframeInterval(const std::string &path, int interval) {
+    return updateEntry(path, [interval](videoInfo &info) { info.keyframeInterval = interval; });
+}
+
+void videoProbeCache::evict() {
+    // a linear scan per eviction, the cache holds a few hundred entries at most
+    while (entries.size() > VIDEO_PROBE_CACHE_ENTRIES) {
+        auto oldest = entries.begin();
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+            if (entry->second.lastUse < oldest->second.lastUse) {
+                oldest = entry;
+            }
+        }
+        entries.erase(oldest);
+    }
+
+    size_t previews = 0;
+    for (const auto &entry : entries) {
+        previews += entry.second.info.preview.empty() ? 0 : 1;
+    }
+
+    for (; previews > VIDEO_PROBE_CACHE_PREVIEWS; --previews) {
+        auto oldest = entries.end();
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+            if (!entry->second.info.preview.empty() &&
+                (oldest == entries.end() || entry->second.lastUse < oldest->second.lastUse)) {
+                oldest = entry;
+            }
+        }
+        oldest->second.info.preview.release();
+    }
+}
@@ -40,6 +40,12 @@ bool yarpVideoModule::configure(yarp::os::ResourceFinder &rf) {
         printf("--robot          : changes the name of the robot where the module interfaces to  \n");
         printf("--name           : rootname for all the connection of the module \n");
         printf("--config       : path of the script to execute \n");
+        printf("--clock          : name of the network clock port to follow \n");
+        printf("--speed          : playback speed factor \n");
+        printf("--local          : use a local-mode yarp network, no yarpserver needed \n");
+        printf("--readAhead      : megabytes of the video file read ahead of the decoder \n");
+        printf("--unpaced        : send every frame as fast as possible \n");
+        printf("--batch          : number of frames per message on /videoBatch:o \n");
         printf(" \n");
         printf("press CTRL-C to stop... \n");
         return true;
@@ -63,6 +69,16 @@ bool yarpVideoModule::configure(yarp::os::ResourceFinder &rf) {
                          Value("icub"),
                          "Robot name (string)").asString();
 
+    /*
+    * optionally follow a network clock (e.g. a simulator) instead of the system one,
+    * the video thread is paced on yarp::os::Time
+    */
+    if (rf.check("clock")) {
+        const string clockPortName = rf.find("clock").asString();
+        yInfo("Using network clock %s", clockPortName.c_str());
+        Time::useNetworkClock(clockPortName);
+    }
+
     /*
     * attach a port of the same name as the module (prefixed with a /) to the module
     * so that messages received from the port are redirected to the respond method
@@ -132,8 +148,19 @@ bool yarpVideoModule::respond(const Bottle &command, Bottle &reply) {
                 reply.addVocab(Vocab::encode("many"));
                 reply.addString("set video <path_to_video> : Change the video to be display");
                 reply.addString("set fps <fps> : Change the fps of the yarpview ");
+                reply.addString("set speed <factor> : Play the video <factor> times faster, from 0.25 to 16, negative to play backwards");
+                reply.addString("set seek <seconds> : Jump to a position of the video");
+                reply.addString("set skip <threshold> : Do not send frames whose mean absolute difference with the last one sent is under threshold");
+                reply.addString("set skip off : Send every frame");
                 reply.addString("set crop <x1> <y1> <x2> <y2> : Crop the video from Point(x1, y1) to Point(x2, y2)");
                 reply.addString("set crop reset : Reset the size of the video to its original size");
+                reply.addString("set roi <name> <x1> <y1> <x2> <y2> : Send the area from Point(x1, y1) to Point(x2, y2) on <module>/roi/<name>:o");
+                reply.addString("set roi <name> remove : Stop sending the area <name> and close its port");
+                reply.addString("get roi : List the areas sent as (name x1 y1 x2 y2)");
+                reply.addString("get frame <index> [<x1> <y1> <x2> <y2>] : On " + getName("/frame:rpc") + ", reply with the image of a frame, cropped if required");
+                reply.addString("get preview <path_to_video> : On " + getName("/frame:rpc") + ", reply with a contact sheet of the video, empty while it is generated");
+                reply.addString("get io : Fill level of the read ahead buffer, stalls of the decoder, refills after seeks and read ahead mode");
+                reply.addString("get stat : Achieved fps and jitter of /video:o, frames sent and repeated, dropped ticks, output size and time of the last video switch");
 
                 ok = true;
             }
@@ -145,8 +172,47 @@ bool yarpVideoModule::respond(const Bottle &command, Bottle &reply) {
                 switch (command.get(1).asVocab()) {
                     case COMMAND_VOCAB_FPS: {
                         const double t_fps = command.get(2).asDouble();
-                        this->videoRateThread->setVideoFPS(t_fps);
-                        ok = true;
+                        ok = this->videoRateThread->setVideoFPS(t_fps);
+                        break;
+                    }
+
+                    case COMMAND_VOCAB_SPEED: {
+                        const double t_speed = command.get(2).asDouble();
+                        ok = this->videoRateThread->setPlaybackSpeed(t_speed);
+                        break;
+                    }
+
+                    case COMMAND_VOCAB_SEEK: {
+                        const double t_seconds = command.get(2).asDouble();
+                        ok = this->videoRateThread->seekVideo(t_seconds);
+                        break;
+                    }
+
+                    case COMMAND_VOCAB_ROI: {
+                        const string roiName = command.get(2).asString();
+
+                        if (strcasecmp(command.get(3).asString().c_str(), "remove") == 0) {
+                            ok = this->videoRateThread->removeRoi(roiName);
+                        } else {
+                            const int x1 = command.get(3).asInt();
+                            const int y1 = command.get(4).asInt();
+
+                            const int x2 = command.get(5).asInt();
+                            const int y2 = command.get(6).asInt();
+
+                            ok = this->videoRateThread->setRoi(roiName, x1, y1, x2, y2);
+                        }
+                        break;
+                    }
+
+                    case COMMAND_VOCAB_SKIP: {
+                        if (strcasecmp(command.get(2).asString().c_str(), "off") == 0) {
+                            this->videoRateThread->setSkipThreshold(-1.0);
+                            ok = true;
+                        } else if ((command.get(2).isInt() || command.get(2).isDouble()) && command.get(2).asDouble() >= 0) {
+                            this->videoRateThread->setSkipThreshold(command.get(2).asDouble());
+                            ok = true;
+                        }
                         break;
                     }
 
@@ -200,6 +266,22 @@ bool yarpVideoModule::respond(const Bottle &command, Bottle &reply) {
             rec = true;
             {
                 switch (command.get(1).asVocab()) {
+                    case COMMAND_VOCAB_STATS: {
+                        this->videoRateThread->getStatistics(reply);
+                        ok = true;
+                        break;
+                    }
+
+                    case COMMAND_VOCAB_IO: {
+                        ok = this->videoRateThread->getReadAheadStatus(reply);
+                        break;
+                    }
+
+                    case COMMAND_VOCAB_ROI: {
+                        this->videoRateThread->getRois(reply);
+                        ok = true;
+                        break;
+                    }
 
                     default:
                         cout << "received an unknown request after a GET" << endl;
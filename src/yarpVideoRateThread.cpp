@@ -22,6 +22,7 @@
  * @brief Implementation of the eventDriven thread (see yarpVideoRateThreadRatethread.h).
  */
 
+#include <algorithm>
 #include <utility>
 
 #include "../include/iCub/yarpVideoRateThread.h"
@@ -36,12 +37,49 @@ using namespace std;
 
 //********************interactionEngineRatethread******************************************************
 
-yarpVideoRateThread::yarpVideoRateThread(yarp::os::ResourceFinder &rf) : RateThread(THRATE) {
+yarpVideoRateThread::yarpVideoRateThread(yarp::os::ResourceFinder &rf) :
+        RateThread(THRATE),
+        previewChannel(rf.check("previewFPS", Value(5.0), "what did the user select?").asDouble()),
+        latestChannel(0.0),
+        reverseBuffer(probeCache, rf.check("reverseChunk", Value(0), "what did the user select?").asInt(),
+                      rf.check("reverseMemory", Value(512), "what did the user select?").asInt()),
+        frameRequests(probeCache, rf.check("frameServerChunk", Value(0), "what did the user select?").asInt(),
+                      rf.check("frameServerCache", Value(2), "what did the user select?").asInt(),
+                      rf.check("frameServerMemory", Value(256), "what did the user select?").asInt()),
+        previews(probeCache,
+                 rf.check("previewColumns", Value(4), "what did the user select?").asInt(),
+                 rf.check("previewRows", Value(4), "what did the user select?").asInt(),
+                 rf.check("previewWidth", Value(160), "what did the user select?").asInt(),
+                 rf.check("previewBudget", Value(0.1), "what did the user select?").asDouble()) {
     robot =  rf.check("robot", Value("icub"), "what did the user select?").asString();
 
     this->videoPath =  rf.check("videoPath", Value(""), "what did the user select?").asString();
+    requestedVideoPath = videoPath;
 
     changedVideo = false;
+    videoChangeTime = -1.0;
+    seekRequest = -1.0;
+
+    const int readAheadMegabytes = rf.check("readAhead", Value(0), "what did the user select?").asInt();
+    readAheadBytes = 0;
+    if (readAheadMegabytes > 0) {
+        readAheadBytes = static_cast<size_t>(readAheadMegabytes) * 1024 * 1024;
+    } else if (readAheadMegabytes < 0) {
+        yWarning("readAhead %d is negative, the video file is not read ahead", readAheadMegabytes);
+    }
+
+    unpaced = rf.check("unpaced");
+    batchSize = rf.check("batch", Value(0), "what did the user select?").asInt();
+    if (batchSize > FRAME_BATCH_MAX_FRAMES) {
+        yWarning("batch %d above %d, the consumers would reject the batches: sending %d frames per batch", batchSize,
+                 FRAME_BATCH_MAX_FRAMES, FRAME_BATCH_MAX_FRAMES);
+        batchSize = FRAME_BATCH_MAX_FRAMES;
+    }
+    pendingBatch = nullptr;
+
+    skipThreshold = rf.check("skipUnchanged", Value(-1.0), "what did the user select?").asDouble();
+    skipRefresh = rf.check("skipRefresh", Value(1.0), "what did the user select?").asDouble();
+    lastSentTime = 0.0;
 
     x1Click =  rf.check("xTopLeft", Value(-1), "what did the user select?").asInt();
     y1Click =  rf.check("yTopLeft", Value(-1), "what did the user select?").asInt();
@@ -50,6 +88,16 @@ yarpVideoRateThread::yarpVideoRateThread(yarp::os::ResourceFinder &rf) : RateThr
 
     videoFPS = rf.check("fps", Value(0), "what did the user select?").asDouble();
 
+    sharedMemoryName = rf.check("sharedMemory", Value(""), "what did the user select?").asString();
+    sharedMemorySlots = rf.check("sharedMemorySlots", Value(4), "what did the user select?").asInt();
+
+    const double speed = rf.check("speed", Value(1.0), "what did the user select?").asDouble();
+    if (!setPlaybackSpeed(speed)) {
+        yWarning("speed %f out of range [%.2f, %.2f] (negative backwards), playing at normal speed", speed,
+                 MIN_PLAYBACK_SPEED, MAX_PLAYBACK_SPEED);
+        playbackSpeed = 1.0;
+    }
+
 }
 
 yarpVideoRateThread::~yarpVideoRateThread(){
@@ -68,6 +116,39 @@ bool yarpVideoRateThread::threadInit() {
         return false;  // unable to open; let RFModule know so that it won't run
     }
 
+    roiOutputs.setPortPrefix(getName("/roi/"));
+
+    if (!repeatFramePort.open(getName("/videoRepeat:o").c_str())) {
+        std::cout << ": unable to open port /videoRepeat:o " << std::endl;
+        return false;
+    }
+
+    if (!previewChannel.open(getName("/videoPreview:o"))) {
+        std::cout << ": unable to open port /videoPreview:o " << std::endl;
+        return false;
+    }
+
+    if (!latestChannel.open(getName("/videoLatest:o"))) {
+        std::cout << ": unable to open port /videoLatest:o " << std::endl;
+        return false;
+    }
+
+    if (!previews.start()) {
+        yError("Unable to start the preview generator");
+        return false;
+    }
+
+    frameRequests.setPreviewSource(&previews);
+    if (!frameRequests.open(getName("/frame:rpc"))) {
+        std::cout << ": unable to open port /frame:rpc " << std::endl;
+        return false;
+    }
+
+    if (batchSize > 0 && !batchPort.open(getName("/videoBatch:o").c_str())) {
+        std::cout << ": unable to open port /videoBatch:o " << std::endl;
+        return false;
+    }
+
     if (videoPath.empty()) {
         cout << "Unable to find the videoPath parameters" << endl;
         return false;
@@ -78,9 +159,28 @@ bool yarpVideoRateThread::threadInit() {
         return false;
     }
 
+    if (!reverseBuffer.start()) {
+        yError("Unable to start the backward playback worker");
+        return false;
+    }
+
+
+    if (!sharedMemoryName.empty()) {
+        if (sharedMemorySlots < 2 ||
+            !frameRing.open(sharedMemoryName, static_cast<unsigned int>(sharedMemorySlots),
+                            static_cast<size_t>(widthInputVideo) * heightInputVideo * 3)) {
+            yError("Unable to create the shared memory frame ring %s", sharedMemoryName.c_str());
+            return false;
+        }
+
+        if (!frameDescriptorPort.open(getName("/frameDescriptor:o").c_str())) {
+            std::cout << ": unable to open port /frameDescriptor:o " << std::endl;
+            return false;
+        }
+    }
 
-    if(!videoFPS){
-        this->videoFPS = m_capVideo->get(CV_CAP_PROP_FPS);
+    if(videoFPS <= 0){
+        this->videoFPS = sourceFPS;
     }
 
     if(x1Click >= 0 && y1Click >= 0 && x2Click >= 0 && y2Click >= 0){
@@ -89,9 +189,6 @@ bool yarpVideoRateThread::threadInit() {
     }
 
 
-
-    this->processingRgbImageBis = new ImageOf<PixelBgr>();
-
     yInfo("Initialization of the processing thread correctly ended");
 
     return true;
@@ -112,62 +209,69 @@ void yarpVideoRateThread::setInputPortName(string InpPort) {
 }
 
 void yarpVideoRateThread::run() {
-    double adjustFactor = 0.0;
-    int currentFPS = 0;
 
+    if (changedVideo) {
+        switchVideo();
+    }
 
-    if (outputVideoPort.getOutputCount() > 0 && m_capVideo->isOpened()) {
-        cv::Mat temporaryFrameHolder;
-        while (m_capVideo->read(temporaryFrameHolder) && !changedVideo && !this->isSuspended()) {
-            const double startTime = time(nullptr);
-            *m_capVideo >> temporaryFrameHolder;
-
-
-            if (!temporaryFrameHolder.empty()) {
-                temporaryIplFrame = cvCreateImage(cvSize(temporaryFrameHolder.cols, temporaryFrameHolder.rows),
-                                                  IPL_DEPTH_8U, 3);
-                *temporaryIplFrame = (IplImage) temporaryFrameHolder;
-
-                if (cropVideo) {
-
-                    iplCropFrme = cvCreateImage(cvSize(rectCropedArea.width, rectCropedArea.height), IPL_DEPTH_8U, 3);
-                    cvSetImageROI(temporaryIplFrame, rectCropedArea);
-                    cvCopy(temporaryIplFrame, iplCropFrme, nullptr);
+    if (hasSubscribers() && m_capVideo->isOpened()) {
 
-                    cvResetImageROI(temporaryIplFrame);
+        // output ticks are scheduled on yarp::os::Time so that playback follows the network clock when one is in use,
+        // the source frame shown at each tick is the one due at the current media time
+        double nextFrameTime = Time::now();
+        double mediaTime = playbackSpeed < 0 ? (videoFrameCount - 1) / sourceFPS : 0.0;
 
-                    temporaryIplFrame = iplCropFrme;
+        while (!this->isSuspended()) {
+            const double framePeriod = 1.0 / videoFPS;
 
+            // a new video starts right away, its first frame is sent as soon as it is decoded
+            if (changedVideo) {
+                switchVideo();
+                if (!m_capVideo->isOpened()) {
+                    break;
                 }
 
+                nextFrameTime = Time::now();
+                mediaTime = playbackSpeed < 0 ? (videoFrameCount - 1) / sourceFPS : 0.0;
+            }
 
-                processingRgbImageBis = &outputVideoPort.prepare();
-                processingRgbImageBis->resize(temporaryIplFrame->width, temporaryIplFrame->height);
-                processingRgbImageBis->wrapIplImage(temporaryIplFrame);
-
-
-                const auto waitTime = (1.0 + readingTimeFrame) / videoFPS;
-                SystemClock::delaySystem(waitTime + adjustFactor);
+            // taken and cleared at once, a seek coming meanwhile is not lost
+            const double seekTime = seekRequest.exchange(-1.0);
+            if (seekTime >= 0) {
+                mediaTime = seekTime;
+            }
 
-                const auto timeElapsed = time(nullptr) - startTime;
-                ++currentFPS;
+            // when behind schedule skip the missed ticks so that the video keeps its pace instead of playing in slow motion
+            const double lateness = Time::now() - nextFrameTime;
+            if (!unpaced && lateness > framePeriod) {
+                const double missedTicks = floor(lateness / framePeriod);
+                nextFrameTime += missedTicks * framePeriod;
+                mediaTime += missedTicks * framePeriod * playbackSpeed;
+                statistics.ticksSkipped(static_cast<int>(missedTicks));
+            }
 
+            const int frameIndex = static_cast<int>(floor(mediaTime * sourceFPS + 1e-6));
+            const int previousFrameIndex = decodedFrameIndex;
 
-                if (timeElapsed == 1) {
+            if (!seekFrame(frameIndex)) {
+                break;  // end of the video
+            }
 
-                    if (currentFPS > videoFPS) {
-                        adjustFactor += 0.01;
-                    } else if (currentFPS < videoFPS) {
-                        adjustFactor -= 0.01;
-                    }
+            if (decodedFrameIndex != previousFrameIndex) {
+                publishFrame(temporaryFrameHolder);
+            }
 
-                    currentFPS = 0;
+            if (unpaced) {
+                // every source frame once, in the playback direction
+                mediaTime += (playbackSpeed < 0 ? -1.0 : 1.0) / sourceFPS;
+            } else {
+                nextFrameTime += framePeriod;
+                mediaTime += framePeriod * playbackSpeed;
 
+                const double waitTime = nextFrameTime - Time::now();
+                if (waitTime > 0) {
+                    Time::delay(waitTime);
                 }
-
-                outputVideoPort.write();
-
-
             }
 
 
@@ -183,82 +287,401 @@ void yarpVideoRateThread::run() {
             }
         }
 
+        flushBatch();
+
+        m_capVideo->set(cv::CAP_PROP_POS_FRAMES, 0);
+        decodedFrameIndex = -1;
+        nextCaptureIndex = 0;
+    }
+
+
+}
+
+void yarpVideoRateThread::switchVideo() {
+    // cleared with the path taken, a request coming during the load is not lost
+    videoPathMutex.wait();
+    videoPath = requestedVideoPath;
+    const double changeTime = videoChangeTime;
+    changedVideo = false;
+    videoPathMutex.post();
+
+    flushBatch();
+    if (!loadVideo()) {
+        return;
+    }
+
+    statistics.reset();
+    statistics.switchRequested(changeTime);
+}
+
+bool yarpVideoRateThread::seekFrame(int frameIndex) {
+
+    if (frameIndex == decodedFrameIndex) {
+        return true;
+    }
+
+    if (frameIndex < 0) {
+        return false;
+    }
+
+    // backwards the frames come from chunks decoded forward ahead of time, the capture is left where it is
+    if (playbackSpeed < 0) {
+        if (!reverseBuffer.getFrame(frameIndex, temporaryFrameHolder)) {
+            return false;
+        }
+
+        decodedFrameIndex = frameIndex;
+        frameFromReverseBuffer = true;
+        return true;
+    }
+
+    // the pixels belong to the backward chunk or are still being sent, decoding in place would overwrite them
+    if (frameFromReverseBuffer || previewChannel.isSending(temporaryFrameHolder) ||
+        latestChannel.isSending(temporaryFrameHolder)) {
+        temporaryFrameHolder.release();
+        frameFromReverseBuffer = false;
+    }
+
+    // the gaps of rate conversion span a few output periods and are grabbed, longer jumps (a seek, a capture left
+    // behind by backward playback) are seeked: the backend then decodes from the previous keyframe only
+    const int grabbedGap = std::max(MIN_GRABBED_GAP,
+                                    4 * static_cast<int>(ceil(sourceFPS * fabs(playbackSpeed) / videoFPS)));
+    if (frameIndex < nextCaptureIndex || frameIndex - nextCaptureIndex > grabbedGap) {
+        m_capVideo->set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+        nextCaptureIndex = frameIndex;
+    }
 
-        if (changedVideo) {
-            loadVideo();
-            changedVideo = false;
+    // frames that are not due are only grabbed, the costly retrieve is kept for the frame that is shown
+    while (nextCaptureIndex < frameIndex) {
+        if (!m_capVideo->grab()) {
+            return false;
         }
-        m_capVideo->set(CV_CAP_PROP_POS_MSEC, 0);
+        ++nextCaptureIndex;
+    }
+
+    if (!m_capVideo->read(temporaryFrameHolder) || temporaryFrameHolder.empty()) {
+        return false;
     }
 
+    decodedFrameIndex = nextCaptureIndex++;
+
+    if (readAhead && !readAhead->isStreaming() && videoFrameCount > 0) {
+        readAhead->setDecodePosition(static_cast<double>(nextCaptureIndex) / videoFrameCount);
+    }
 
+    return true;
 }
 
+void yarpVideoRateThread::publishFrame(const cv::Mat &frame) {
 
-void yarpVideoRateThread::threadRelease() {
-    m_capVideo->release();
-    outputVideoPort.close();
+    if (frameRing.isOpen()) {
+        shareFrame(frame);
+    }
+
+    publishStamp.update(Time::now());
+    roiOutputs.publish(frame, publishStamp);
 
+    const cv::Mat outputFrame = cropVideo ? frame(rectCropedArea & cv::Rect(0, 0, frame.cols, frame.rows)) : frame;
+
+    previewChannel.offer(outputFrame, publishStamp);
+    latestChannel.offer(outputFrame, publishStamp);
+
+    if (batchSize > 0) {
+        batchFrame(outputFrame);
+    }
+
+    if (isUnchangedFrame(outputFrame)) {
+        statistics.frameRepeated();
+
+        // consumers keep their last frame, the ones that care are told which frame it stands for
+        if (repeatFramePort.getOutputCount() > 0) {
+            Bottle &repeatFrame = repeatFramePort.prepare();
+            repeatFrame.clear();
+            repeatFrame.addString("repeat");
+            repeatFrame.addInt(frameStamp.getCount());
+            repeatFrame.addInt(decodedFrameIndex);
+            repeatFrame.addDouble(Time::now());
+            repeatFramePort.write();
+        }
+    } else if (outputVideoPort.getOutputCount() > 0) {
+        ImageOf<PixelBgr> &outputImage = outputVideoPort.prepare();
+        outputImage.resize(outputFrame.cols, outputFrame.rows);
+
+        // copy the frame (or the cropped area) straight into the port buffer, honouring the yarp row padding
+        cv::Mat outputBuffer(outputFrame.rows, outputFrame.cols, CV_8UC3, outputImage.getRawImage(),
+                             static_cast<size_t>(outputImage.getRowSize()));
+        outputFrame.copyTo(outputBuffer);
+
+        frameStamp.update(Time::now());
+        outputVideoPort.setEnvelope(frameStamp);
+        outputVideoPort.write();
+
+        if (skipThreshold >= 0) {
+            outputFrame.copyTo(lastSentFrame);
+            lastSentTime = Time::now();
+        }
+
+        statistics.frameSent(frameStamp.getTime(), outputFrame.cols, outputFrame.rows);
+    }
 }
 
+void yarpVideoRateThread::shareFrame(const cv::Mat &frame) {
 
-void yarpVideoRateThread::setVideoFPS(double t_fps) {
-    this->videoFPS = t_fps;
+    const cv::Rect activeCrop = cropVideo ? rectCropedArea : cv::Rect();
+    const double timestamp = Time::now();
+
+    unsigned int slot = 0;
+    const uint64_t sequence = frameRing.write(frame, decodedFrameIndex, activeCrop, timestamp, slot);
+
+    if (sequence == 0 || frameDescriptorPort.getOutputCount() == 0) {
+        return;
+    }
 
+    // sequence numbers can exceed the range of a yarp int, they are sent as double (exact up to 2^53)
+    Bottle &frameDescriptor = frameDescriptorPort.prepare();
+    frameDescriptor.clear();
+    frameDescriptor.addString(frameRing.getName());
+    frameDescriptor.addDouble(static_cast<double>(sequence));
+    frameDescriptor.addInt(static_cast<int>(slot));
+    frameDescriptor.addInt(frame.cols);
+    frameDescriptor.addInt(frame.rows);
+    frameDescriptor.addInt(decodedFrameIndex);
+    frameDescriptor.addDouble(timestamp);
+    frameDescriptorPort.write();
 }
 
-void yarpVideoRateThread::setVideoPath(std::string t_videoPath) {
-    this->videoPath = std::move(t_videoPath);
-    changedVideo = true;
+bool yarpVideoRateThread::isUnchangedFrame(const cv::Mat &frame) {
 
+    if (skipThreshold < 0 || lastSentFrame.size() != frame.size() || Time::now() - lastSentTime >= skipRefresh) {
+        return false;
+    }
 
+    // cv::norm runs a vectorised sum of absolute differences, the crop is compared in place without copy
+    const double meanDifference = cv::norm(frame, lastSentFrame, cv::NORM_L1) / (frame.total() * frame.channels());
+    return meanDifference <= skipThreshold;
 }
 
-bool yarpVideoRateThread::loadVideo() {
+void yarpVideoRateThread::batchFrame(const cv::Mat &frame) {
 
-    m_capVideo = std::unique_ptr<cv::VideoCapture>(new cv::VideoCapture(this->videoPath)); // open a video file
+    if (batchPort.getOutputCount() == 0) {
+        return;
+    }
 
-    if (!m_capVideo->isOpened())  // check if succeeded
-    {
-        yError(" file  %s not found or could not be opened", this->videoPath.c_str());
+    // a batch holds frames of a single size, a new crop or video starts a new one
+    if (pendingBatch != nullptr && (frame.cols != pendingBatch->getWidth() || frame.rows != pendingBatch->getHeight())) {
+        flushBatch();
+    }
+
+    if (pendingBatch == nullptr) {
+        pendingBatch = &batchPort.prepare();
+        pendingBatch->reset(frame.cols, frame.rows, batchSize);
+    }
+
+    pendingBatch->append(frame, decodedFrameIndex, Time::now());
+
+    if (pendingBatch->size() >= batchSize) {
+        flushBatch();
+    }
+}
+
+void yarpVideoRateThread::flushBatch() {
+
+    if (pendingBatch == nullptr) {
+        return;
+    }
+
+    // offline consumers want every frame, unpaced batches wait for the previous one to be sent
+    if (unpaced) {
+        batchPort.writeStrict();
+    } else {
+        batchPort.write();
+    }
+    pendingBatch = nullptr;
+}
+
+void yarpVideoRateThread::setSkipThreshold(double t_threshold) {
+    this->skipThreshold = t_threshold;
+}
+
+void yarpVideoRateThread::getStatistics(Bottle &reply) {
+    statistics.report(reply);
+}
+
+bool yarpVideoRateThread::getReadAheadStatus(Bottle &reply) {
+    // the copy keeps the stream alive even if the video thread switches to another video meanwhile
+    readAheadMutex.wait();
+    const cv::Ptr<readAheadStream> stream = readAhead;
+    readAheadMutex.post();
+
+    if (!stream) {
+        return false;
+    }
+
+    Bottle &fillEntry = reply.addList();
+    fillEntry.addString("fill");
+    fillEntry.addDouble(stream->getFillLevel());
+
+    Bottle &stallsEntry = reply.addList();
+    stallsEntry.addString("stalls");
+    stallsEntry.addInt(stream->getStalls());
+
+    Bottle &refillsEntry = reply.addList();
+    refillsEntry.addString("refills");
+    refillsEntry.addInt(stream->getRefills());
+
+    Bottle &modeEntry = reply.addList();
+    modeEntry.addString("mode");
+    modeEntry.addString(stream->isStreaming() ? "stream" : "cache");
+
+    return true;
+}
+
+bool yarpVideoRateThread::setRoi(const std::string &roiName, int x1, int y1, int x2, int y2) {
+    return x1 >= 0 && y1 >= 0 && roiOutputs.setRoi(roiName, cv::Rect(x1, y1, x2 - x1, y2 - y1));
+}
+
+bool yarpVideoRateThread::removeRoi(const std::string &roiName) {
+    return roiOutputs.removeRoi(roiName);
+}
+
+void yarpVideoRateThread::getRois(Bottle &reply) {
+    roiOutputs.listRois(reply);
+}
+
+bool yarpVideoRateThread::hasSubscribers() {
+    return outputVideoPort.getOutputCount() > 0 || roiOutputs.hasSubscribers() || batchPort.getOutputCount() > 0 ||
+           previewChannel.hasSubscribers() || latestChannel.hasSubscribers() ||
+           (frameRing.isOpen() && frameDescriptorPort.getOutputCount() > 0);
+}
+
+
+void yarpVideoRateThread::threadRelease() {
+    reverseBuffer.stop();
+    frameRequests.close();
+    previews.stop();
+    m_capVideo->release();
+    readAheadMutex.wait();
+    readAhead.release();
+    readAheadMutex.post();
+    outputVideoPort.close();
+    inputYarpviewClickPort.close();
+    frameDescriptorPort.close();
+    repeatFramePort.close();
+    batchPort.close();
+    previewChannel.close();
+    latestChannel.close();
+    roiOutputs.close();
+    frameRing.close();
+
+}
+
+
+bool yarpVideoRateThread::setVideoFPS(double t_fps) {
+    if (t_fps <= 0) {
         return false;
     }
 
+    this->videoFPS = t_fps;
+    return true;
+}
 
-    cv::Mat temporaryFrameHolder;
+bool yarpVideoRateThread::setPlaybackSpeed(double t_speed) {
+    if (fabs(t_speed) < MIN_PLAYBACK_SPEED || fabs(t_speed) > MAX_PLAYBACK_SPEED) {
+        return false;
+    }
 
-    *m_capVideo >> temporaryFrameHolder;
+    this->playbackSpeed = t_speed;
+    return true;
+}
 
-    widthInputVideo = temporaryFrameHolder.cols;
-    heightInputVideo = temporaryFrameHolder.rows;
+bool yarpVideoRateThread::seekVideo(double t_seconds) {
+    if (t_seconds < 0) {
+        return false;
+    }
 
-    computeReadingTime();
+    this->seekRequest = t_seconds;
     return true;
 }
 
-double yarpVideoRateThread::computeReadingTime() {
+void yarpVideoRateThread::setVideoPath(std::string t_videoPath) {
+    videoPathMutex.wait();
+    requestedVideoPath = std::move(t_videoPath);
+    videoChangeTime = Time::now();
+    changedVideo = true;
+    videoPathMutex.post();
 
-    clock_t startTime = clock();
 
-    cv::Mat temporaryFrameHolder;
+}
 
-    *m_capVideo >> temporaryFrameHolder;
+bool yarpVideoRateThread::loadVideo() {
 
+    m_capVideo.reset();
+
+    // the previous stream is released out of the lock, its thread is joined if rpc does not hold it anymore
+    readAheadMutex.wait();
+    cv::Ptr<readAheadStream> previousStream = readAhead;
+    readAhead.release();
+    readAheadMutex.post();
+    previousStream.release();
+
+    if (readAheadBytes > 0) {
+        cv::Ptr<readAheadStream> stream = cv::makePtr<readAheadStream>(readAheadBytes, static_cast<size_t>(READ_AHEAD_CHUNK));
+#ifdef READ_AHEAD_STREAM_READER
+        // the decoder reads from the ring, the file is only touched by the read ahead thread
+        if (stream->open(this->videoPath, true)) {
+            m_capVideo = std::unique_ptr<cv::VideoCapture>(new cv::VideoCapture(stream, cv::CAP_ANY, std::vector<int>()));
+
+            if (!m_capVideo->isOpened()) {
+                yWarning("No backend reads %s from a stream, the read ahead only warms the page cache", this->videoPath.c_str());
+                m_capVideo.reset();
+                stream = cv::makePtr<readAheadStream>(readAheadBytes, static_cast<size_t>(READ_AHEAD_CHUNK));
+            }
+        }
+#endif
+        if (!m_capVideo) {
+            stream->open(this->videoPath, false);
+        }
 
-    IplImage temporaryIplFrame = (IplImage) temporaryFrameHolder;
-    yarp::sig::ImageOf<yarp::sig::PixelBgr> *processingRgbImageBis = &outputVideoPort.prepare();
-    processingRgbImageBis->resize(temporaryIplFrame.width, temporaryIplFrame.height);
-    processingRgbImageBis->wrapIplImage(&temporaryIplFrame); //temp_r_ipl
+        readAheadMutex.wait();
+        readAhead = stream;
+        readAheadMutex.post();
+    }
 
+    if (!m_capVideo) {
+        m_capVideo = std::unique_ptr<cv::VideoCapture>(new cv::VideoCapture(this->videoPath)); // open a video file
+    }
 
-    clock_t endTime = clock();
+    if (!m_capVideo->isOpened())  // check if succeeded
+    {
+        yError(" file  %s not found or could not be opened", this->videoPath.c_str());
+        return false;
+    }
 
-    readingTimeFrame = ((endTime - startTime) / (CLOCKS_PER_SEC / 1000)) / 1000;
 
-    m_capVideo->set(CV_CAP_PROP_POS_MSEC, 0);
+    videoInfo info;
+    if (!probeCache.probe(this->videoPath, *m_capVideo, info)) {
+        yError("Unable to read the frame size of %s", this->videoPath.c_str());
+        return false;
+    }
 
+    widthInputVideo = info.width;
+    heightInputVideo = info.height;
 
-    return readingTimeFrame;
+    sourceFPS = info.fps;
+    if (sourceFPS <= 0) {
+        yWarning("Unable to read the fps of %s, assuming %.1f", this->videoPath.c_str(), DEFAULT_SOURCE_FPS);
+        sourceFPS = DEFAULT_SOURCE_FPS;
+    }
+
+    videoFrameCount = info.frameCount;
+
+    reverseBuffer.setVideo(this->videoPath);
+    frameRequests.setVideo(this->videoPath);
+
+    decodedFrameIndex = -1;
+    nextCaptureIndex = 0;
+    frameFromReverseBuffer = false;
+    return true;
 }
 
 bool yarpVideoRateThread::computeCropArea(int x1, int y1, int x2, int y2) {
@@ -309,6 +732,13 @@ void yarpVideoRateThread::interrupt() {
     this->suspend();
     outputVideoPort.interrupt();
     inputYarpviewClickPort.interrupt();
+    frameDescriptorPort.interrupt();
+    repeatFramePort.interrupt();
+    batchPort.interrupt();
+    previewChannel.interrupt();
+    latestChannel.interrupt();
+    frameRequests.interrupt();
+    roiOutputs.interrupt();
 
 }
 
@@ -0,0 +1,224 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+  * Copyright (C)2017  Department of Robotics Brain and Cognitive Sciences - Istituto Italiano di Tecnologia
+  * Author: jonas gonzalez
+  * email:
+  * Permission is granted to copy, distribute, and/or modify this program
+  * under the terms of the GNU General Public License, version 2 or any
+  * later version published by the Free Software Foundation.
+  *
+  * A copy of the license can be found at
+  * http://www.robotcub.org/icub/license/gpl.txt
+  *
+  * This program is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+  * Public License for more details
+*/
+
+/**
+ * @file playbackTimingTest.cpp
+ * @brief Plays generated clips through yarpVideoModule on a local-mode network and checks the timing it reports.
+ *
+ * Checks the fps and jitter of /video:o against the clip rate, the output size after \c set \c crop and the time
+ * of a \c set \c video switch reported by \c get \c stat. Usage: playbackTimingTest <directory_for_the_clips>
+ */
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../include/iCub/yarpVideoModule.h"
+
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace std;
+
+#define CLIP_FPS        25.0
+#define CLIP_SECONDS    10
+#define FPS_TOLERANCE   0.1         // relative
+#define JITTER_LIMIT    0.01        // seconds
+#define SWITCH_LIMIT    1.0         // seconds
+#define READ_TIMEOUT    5.0         // seconds
+
+static int failures = 0;
+
+static void check(bool condition, const string &what) {
+    if (!condition) {
+        yError("FAILED: %s", what.c_str());
+        ++failures;
+    } else {
+        yInfo("passed: %s", what.c_str());
+    }
+}
+
+/**
+ * Write a clip whose frames all differ, so that none is skipped as unchanged
+ */
+static bool writeClip(const string &path, int width, int height) {
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), CLIP_FPS, cv::Size(width, height));
+    if (!writer.isOpened()) {
+        return false;
+    }
+
+    const int frameCount = static_cast<int>(CLIP_FPS) * CLIP_SECONDS;
+    for (int i = 0; i < frameCount; ++i) {
+        cv::Mat frame(height, width, CV_8UC3, cv::Scalar(i % 256, (3 * i) % 256, 128));
+        cv::rectangle(frame, cv::Rect((4 * i) % (width - 20), height / 2 - 10, 20, 20), cv::Scalar(255, 255, 255), -1);
+        writer.write(frame);
+    }
+
+    return true;
+}
+
+/**
+ * Read the next frame of the port, with its send time
+ * @return nullptr if no frame came within READ_TIMEOUT
+ */
+static ImageOf<PixelBgr> *readFrame(BufferedPort<ImageOf<PixelBgr> > &reader, double &sendTime) {
+    const double deadline = Time::now() + READ_TIMEOUT;
+    while (Time::now() < deadline) {
+        ImageOf<PixelBgr> *frame = reader.read(false);
+        if (frame != nullptr) {
+            Stamp envelope;
+            reader.getEnvelope(envelope);
+            sendTime = envelope.getTime();
+            return frame;
+        }
+        Time::delay(0.001);
+    }
+
+    return nullptr;
+}
+
+/**
+ * Read frames until one of the given size comes
+ * @return false if none came within maxFrames
+ */
+static bool waitFrameSize(BufferedPort<ImageOf<PixelBgr> > &reader, int width, int height, int maxFrames) {
+    double sendTime = 0.0;
+    for (int i = 0; i < maxFrames; ++i) {
+        const ImageOf<PixelBgr> *frame = readFrame(reader, sendTime);
+        if (frame == nullptr) {
+            return false;
+        }
+        if (static_cast<int>(frame->width()) == width && static_cast<int>(frame->height()) == height) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) {
+        yError("usage: playbackTimingTest <directory_for_the_clips>");
+        return 1;
+    }
+
+    Network yarp;
+    Network::setLocalMode(true);
+
+    const string firstClip = string(argv[1]) + "/timingClip320.avi";
+    const string secondClip = string(argv[1]) + "/timingClip160.avi";
+    if (!writeClip(firstClip, 320, 240) || !writeClip(secondClip, 160, 120)) {
+        yError("Unable to write the test clips in %s", argv[1]);
+        return 1;
+    }
+
+    vector<string> arguments = {"playbackTimingTest", "--name", "/timingTest", "--videoPath", firstClip};
+    vector<char *> argumentPointers;
+    for (string &argument : arguments) {
+        argumentPointers.push_back(&argument[0]);
+    }
+
+    ResourceFinder rf;
+    rf.configure(static_cast<int>(argumentPointers.size()), argumentPointers.data());
+
+    yarpVideoModule module;
+    if (!module.configure(rf)) {
+        yError("Unable to configure the module");
+        return 1;
+    }
+
+    BufferedPort<ImageOf<PixelBgr> > reader;
+    reader.setStrict();
+    if (!reader.open("/timingTest/reader:i") || !Network::connect("/timingTest/video:o", "/timingTest/reader:i")) {
+        yError("Unable to connect to /timingTest/video:o");
+        module.close();
+        return 1;
+    }
+
+    // fps and jitter of the frames sent, measured on their envelopes and as reported by the module
+    double sendTime = 0.0;
+    vector<double> sendTimes;
+    for (int i = 0; i < 65 && readFrame(reader, sendTime) != nullptr; ++i) {
+        if (i >= 5) {   // start-up frames
+            sendTimes.push_back(sendTime);
+        }
+    }
+    check(sendTimes.size() == 60, "60 frames received on /video:o");
+
+    if (sendTimes.size() > 2) {
+        const double meanInterval = (sendTimes.back() - sendTimes.front()) / (sendTimes.size() - 1);
+        double sumSquares = 0.0;
+        for (size_t i = 1; i < sendTimes.size(); ++i) {
+            const double deviation = (sendTimes[i] - sendTimes[i - 1]) - meanInterval;
+            sumSquares += deviation * deviation;
+        }
+        const double receivedJitter = sqrt(sumSquares / (sendTimes.size() - 1));
+
+        check(fabs(1.0 / meanInterval - CLIP_FPS) < FPS_TOLERANCE * CLIP_FPS, "fps of the envelopes within tolerance");
+        check(receivedJitter < JITTER_LIMIT, "jitter of the envelopes within tolerance");
+    }
+
+    Bottle command, reply;
+    command.addVocab(COMMAND_VOCAB_GET);
+    command.addVocab(COMMAND_VOCAB_STATS);
+    check(module.respond(command, reply), "get stat succeeds");
+    check(fabs(reply.find("fps").asDouble() - CLIP_FPS) < FPS_TOLERANCE * CLIP_FPS, "fps of get stat within tolerance");
+    check(reply.find("jitter").asDouble() < JITTER_LIMIT, "jitter of get stat within tolerance");
+
+    // the crop applies to the following frames
+    command.clear();
+    command.addVocab(COMMAND_VOCAB_SET);
+    command.addVocab(COMMAND_VOCAB_CROP);
+    command.addInt(40);
+    command.addInt(20);
+    command.addInt(200);
+    command.addInt(140);
+    check(module.respond(command, reply), "set crop succeeds");
+    check(waitFrameSize(reader, 160, 120, 25), "cropped frames of 160x120 on /video:o");
+
+    command.clear();
+    command.addVocab(COMMAND_VOCAB_SET);
+    command.addVocab(COMMAND_VOCAB_CROP);
+    command.addString("reset");
+    check(module.respond(command, reply), "set crop reset succeeds");
+    check(waitFrameSize(reader, 320, 240, 25), "full frames of 320x240 on /video:o");
+
+    // the switch time is taken when the first frame of the new video is sent
+    command.clear();
+    command.addVocab(COMMAND_VOCAB_SET);
+    command.addVocab(COMMAND_VOCAB_VIDEO);
+    command.addString(secondClip);
+    check(module.respond(command, reply), "set video succeeds");
+    check(waitFrameSize(reader, 160, 120, 50), "frames of the new video on /video:o");
+
+    command.clear();
+    command.addVocab(COMMAND_VOCAB_GET);
+    command.addVocab(COMMAND_VOCAB_STATS);
+    check(module.respond(command, reply), "get stat succeeds after the switch");
+    const double switchTime = reply.find("switch").asDouble();
+    check(switchTime > 0.0 && switchTime < SWITCH_LIMIT, "switch time of get stat within tolerance");
+
+    reader.interrupt();
+    reader.close();
+    module.interruptModule();
+    module.close();
+
+    yInfo("%d check(s) failed", failures);
+    return failures == 0 ? 0 : 1;
+}